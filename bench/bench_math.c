@@ -0,0 +1,556 @@
+// clock_gettime and CLOCK_MONOTONIC are POSIX, not ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "test_matrix/cpu_features.h"
+#include "test_matrix/frustum.h"
+#include "test_matrix/mat4f.h"
+#include "test_matrix/vec3f.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define BENCH_INPUT_COUNT 256
+#define BENCH_POINT_COUNT 4096
+
+typedef enum BenchFormat
+{
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_JSON
+} BenchFormat;
+
+typedef struct BenchCase
+{
+    const char* name;
+    // Runs the operation `iterations` times and returns a value derived from the results
+    float (*run)(const size_t iterations);
+    // Kernel the case actually runs, which for dispatching functions depends on the CPU
+    const char* kernel;
+    // Number of operations one iteration performs, e.g. points per batched transform
+    size_t ops_per_iteration;
+    bool is_supported;
+} BenchCase;
+
+typedef struct BenchResult
+{
+    double ns_per_op_mean;
+    double ns_per_op_min;
+    double ns_per_op_max;
+    double ns_per_op_variance;
+    double ops_per_second;
+} BenchResult;
+
+static Mat4f input_mats[BENCH_INPUT_COUNT];
+static Vec3f input_vecs[BENCH_INPUT_COUNT];
+
+static Vec3f points_in[BENCH_POINT_COUNT];
+static Vec3f points_out[BENCH_POINT_COUNT];
+static float points_in_soa[3][BENCH_POINT_COUNT];
+static float points_out_soa[3][BENCH_POINT_COUNT];
+
+static Frustum cull_frustum;
+static float sphere_radii[BENCH_POINT_COUNT];
+static uint32_t visible_spheres[BENCH_POINT_COUNT];
+
+// Keeps the compiler from discarding the benchmarked work
+static volatile float sink;
+
+static uint64_t get_time_ns(void);
+
+static void init_inputs(void);
+
+static BenchResult run_bench_case(const BenchCase* const bench_case, const size_t iterations,
+    const int repetitions);
+
+static void print_usage(const char* const program_name);
+
+static float run_mat4f_product_dispatch(const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const Mat4f product = mat4f_product(&input_mats[i % BENCH_INPUT_COUNT],
+            &input_mats[(i + 1) % BENCH_INPUT_COUNT]);
+        result += product.value[i % 4][(i / 4) % 4];
+    }
+    return result;
+}
+
+static float run_mat4f_product_with(const Mat4fProductFn kernel, const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const Mat4f product = kernel(&input_mats[i % BENCH_INPUT_COUNT],
+            &input_mats[(i + 1) % BENCH_INPUT_COUNT]);
+        result += product.value[i % 4][(i / 4) % 4];
+    }
+    return result;
+}
+
+static float run_mat4f_product_scalar(const size_t iterations)
+{
+    return run_mat4f_product_with(mat4f_product_scalar, iterations);
+}
+
+#if CPU_FEATURES_SSE2
+static float run_mat4f_product_sse(const size_t iterations)
+{
+    return run_mat4f_product_with(mat4f_product_sse, iterations);
+}
+
+static float run_mat4f_product_avx2(const size_t iterations)
+{
+    return run_mat4f_product_with(mat4f_product_avx2, iterations);
+}
+#endif
+
+static float run_vec3f_normalize(const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const Vec3f normalized = vec3f_normalize(&input_vecs[i % BENCH_INPUT_COUNT]);
+        result += normalized.value[i % 3];
+    }
+    return result;
+}
+
+static float run_vec3f_cross(const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const Vec3f cross = vec3f_cross(&input_vecs[i % BENCH_INPUT_COUNT],
+            &input_vecs[(i + 1) % BENCH_INPUT_COUNT]);
+        result += cross.value[i % 3];
+    }
+    return result;
+}
+
+// Camera basis and view matrix the way main() builds them after a mouse move
+static float run_look_at_product(const size_t iterations)
+{
+    const Vec3f world_up = {{0.0f, 1.0f, 0.0f}};
+
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const Vec3f camera_dir = vec3f_normalize(&input_vecs[i % BENCH_INPUT_COUNT]);
+        const Vec3f* const camera_pos = &input_vecs[(i + 1) % BENCH_INPUT_COUNT];
+
+        Vec3f camera_right = vec3f_cross(&camera_dir, &world_up);
+        camera_right = vec3f_normalize(&camera_right);
+        const Vec3f camera_up = vec3f_cross(&camera_right, &camera_dir);
+
+        const float* const R = camera_right.value;
+        const float* const U = camera_up.value;
+        const float* const D = camera_dir.value;
+        const float* const P = camera_pos->value;
+
+        const Mat4f mat1 = {.value = {
+            {R[0], R[1], R[2], 0.0f},
+            {U[0], U[1], U[2], 0.0f},
+            {D[0], D[1], D[2], 0.0f},
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        }};
+
+        const Mat4f mat2 = {.value = {
+            {1.0f, 0.0f, 0.0f, -P[0]},
+            {0.0f, 1.0f, 0.0f, -P[1]},
+            {0.0f, 0.0f, 1.0f, -P[2]},
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        }};
+
+        const Mat4f look_at_matrix = mat4f_product(&mat1, &mat2);
+        result += look_at_matrix.value[i % 3][3];
+    }
+    return result;
+}
+
+// Same camera update with the view matrix written out directly
+static float run_look_at_direct(const size_t iterations)
+{
+    const Vec3f world_up = {{0.0f, 1.0f, 0.0f}};
+
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const Vec3f camera_dir = vec3f_normalize(&input_vecs[i % BENCH_INPUT_COUNT]);
+        const Vec3f* const camera_pos = &input_vecs[(i + 1) % BENCH_INPUT_COUNT];
+
+        Vec3f camera_right = vec3f_cross(&camera_dir, &world_up);
+        camera_right = vec3f_normalize(&camera_right);
+        const Vec3f camera_up = vec3f_cross(&camera_right, &camera_dir);
+
+        const Mat4f look_at_matrix = mat4f_look_at(&camera_right, &camera_up, &camera_dir, camera_pos);
+        result += look_at_matrix.value[i % 3][3];
+    }
+    return result;
+}
+
+// Matrix construction alone, without the basis computation both camera updates share
+static float run_look_at_matrix_product(const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const float* const R = input_vecs[i % BENCH_INPUT_COUNT].value;
+        const float* const U = input_vecs[(i + 1) % BENCH_INPUT_COUNT].value;
+        const float* const D = input_vecs[(i + 2) % BENCH_INPUT_COUNT].value;
+        const float* const P = input_vecs[(i + 3) % BENCH_INPUT_COUNT].value;
+
+        const Mat4f mat1 = {.value = {
+            {R[0], R[1], R[2], 0.0f},
+            {U[0], U[1], U[2], 0.0f},
+            {D[0], D[1], D[2], 0.0f},
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        }};
+
+        const Mat4f mat2 = {.value = {
+            {1.0f, 0.0f, 0.0f, -P[0]},
+            {0.0f, 1.0f, 0.0f, -P[1]},
+            {0.0f, 0.0f, 1.0f, -P[2]},
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        }};
+
+        const Mat4f look_at_matrix = mat4f_product(&mat1, &mat2);
+        result += look_at_matrix.value[i % 3][3];
+    }
+    return result;
+}
+
+static float run_mat4f_look_at(const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const Mat4f look_at_matrix = mat4f_look_at(&input_vecs[i % BENCH_INPUT_COUNT],
+            &input_vecs[(i + 1) % BENCH_INPUT_COUNT], &input_vecs[(i + 2) % BENCH_INPUT_COUNT],
+            &input_vecs[(i + 3) % BENCH_INPUT_COUNT]);
+        result += look_at_matrix.value[i % 3][3];
+    }
+    return result;
+}
+
+static float run_mat4f_transform_points(const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        mat4f_transform_points(&input_mats[i % BENCH_INPUT_COUNT], points_in, points_out, BENCH_POINT_COUNT);
+        result += points_out[i % BENCH_POINT_COUNT].value[0];
+    }
+    return result;
+}
+
+static float run_mat4f_transform_points_soa(const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        mat4f_transform_points_soa(&input_mats[i % BENCH_INPUT_COUNT],
+            points_in_soa[0], points_in_soa[1], points_in_soa[2],
+            points_out_soa[0], points_out_soa[1], points_out_soa[2], BENCH_POINT_COUNT);
+        result += points_out_soa[0][i % BENCH_POINT_COUNT];
+    }
+    return result;
+}
+
+static float run_frustum_cull_spheres_with(const FrustumCullSpheresFn kernel, const size_t iterations)
+{
+    float result = 0.0f;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const size_t visible_count = kernel(&cull_frustum, points_in_soa[0], points_in_soa[1], points_in_soa[2],
+            sphere_radii, BENCH_POINT_COUNT, visible_spheres);
+        result += (float)visible_count;
+    }
+    return result;
+}
+
+static float run_frustum_cull_spheres(const size_t iterations)
+{
+    return run_frustum_cull_spheres_with(frustum_cull_spheres, iterations);
+}
+
+static float run_frustum_cull_spheres_scalar(const size_t iterations)
+{
+    return run_frustum_cull_spheres_with(frustum_cull_spheres_scalar, iterations);
+}
+
+#if CPU_FEATURES_SSE2
+static float run_frustum_cull_spheres_sse(const size_t iterations)
+{
+    return run_frustum_cull_spheres_with(frustum_cull_spheres_sse, iterations);
+}
+
+static float run_frustum_cull_spheres_avx2(const size_t iterations)
+{
+    return run_frustum_cull_spheres_with(frustum_cull_spheres_avx2, iterations);
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+    BenchFormat format = BENCH_FORMAT_CSV;
+    size_t iterations = 5000000;
+    int repetitions = 10;
+    const char* filter = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            ++i;
+            if (strcmp(argv[i], "csv") == 0)
+            {
+                format = BENCH_FORMAT_CSV;
+            }
+            else if (strcmp(argv[i], "json") == 0)
+            {
+                format = BENCH_FORMAT_JSON;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown format %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            iterations = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+        {
+            repetitions = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (iterations == 0 || repetitions <= 0)
+    {
+        fputs("Iterations and repetitions must be positive\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    init_inputs();
+
+    const CpuFeatures* const features = cpu_features_get();
+
+    const BenchCase bench_cases[] = {
+        {"mat4f_product", run_mat4f_product_dispatch, mat4f_product_kernel_name(), 1, true},
+        {"mat4f_product_scalar", run_mat4f_product_scalar, "scalar", 1, true},
+#if CPU_FEATURES_SSE2
+        {"mat4f_product_sse", run_mat4f_product_sse, "sse", 1, true},
+        {"mat4f_product_avx2", run_mat4f_product_avx2, "avx2", 1, features->avx2 && features->fma},
+#endif
+        {"vec3f_normalize", run_vec3f_normalize, "scalar", 1, true},
+        {"vec3f_cross", run_vec3f_cross, "scalar", 1, true},
+        {"look_at_product", run_look_at_product, mat4f_product_kernel_name(), 1, true},
+        {"look_at_direct", run_look_at_direct, "scalar", 1, true},
+        {"look_at_matrix_product", run_look_at_matrix_product, mat4f_product_kernel_name(), 1, true},
+        {"mat4f_look_at", run_mat4f_look_at, "scalar", 1, true},
+        {"mat4f_transform_points", run_mat4f_transform_points, mat4f_transform_points_kernel_name(),
+            BENCH_POINT_COUNT, true},
+        {"mat4f_transform_points_soa", run_mat4f_transform_points_soa, mat4f_transform_points_soa_kernel_name(),
+            BENCH_POINT_COUNT, true},
+        {"frustum_cull_spheres", run_frustum_cull_spheres, frustum_cull_spheres_kernel_name(),
+            BENCH_POINT_COUNT, true},
+        {"frustum_cull_spheres_scalar", run_frustum_cull_spheres_scalar, "scalar", BENCH_POINT_COUNT, true},
+#if CPU_FEATURES_SSE2
+        {"frustum_cull_spheres_sse", run_frustum_cull_spheres_sse, "sse", BENCH_POINT_COUNT, true},
+        {"frustum_cull_spheres_avx2", run_frustum_cull_spheres_avx2, "avx2", BENCH_POINT_COUNT,
+            features->avx2 && features->fma},
+#endif
+    };
+    (void)features;
+
+    const size_t bench_case_count = sizeof(bench_cases) / sizeof(bench_cases[0]);
+
+    if (format == BENCH_FORMAT_CSV)
+    {
+        puts("benchmark,kernel,iterations,repetitions,ns_per_op_mean,ns_per_op_min,ns_per_op_max,"
+            "ns_per_op_variance,ops_per_second");
+    }
+    else
+    {
+        fputs("{\n  \"benchmarks\": [", stdout);
+    }
+
+    bool is_first_result = true;
+    for (size_t i = 0; i < bench_case_count; ++i)
+    {
+        const BenchCase* const bench_case = &bench_cases[i];
+        if (!bench_case->is_supported || (filter != NULL && strstr(bench_case->name, filter) == NULL))
+        {
+            continue;
+        }
+
+        // Batched cases do thousands of operations per iteration
+        const size_t case_iterations = iterations / bench_case->ops_per_iteration > 0
+            ? iterations / bench_case->ops_per_iteration
+            : 1;
+
+        const BenchResult result = run_bench_case(bench_case, case_iterations, repetitions);
+
+        if (format == BENCH_FORMAT_CSV)
+        {
+            printf("%s,%s,%zu,%d,%.4f,%.4f,%.4f,%.6f,%.0f\n", bench_case->name, bench_case->kernel,
+                case_iterations, repetitions, result.ns_per_op_mean, result.ns_per_op_min, result.ns_per_op_max,
+                result.ns_per_op_variance, result.ops_per_second);
+        }
+        else
+        {
+            printf("%s\n    {\"benchmark\": \"%s\", \"kernel\": \"%s\", \"iterations\": %zu, \"repetitions\": %d, "
+                "\"ns_per_op_mean\": %.4f, \"ns_per_op_min\": %.4f, \"ns_per_op_max\": %.4f, "
+                "\"ns_per_op_variance\": %.6f, \"ops_per_second\": %.0f}",
+                is_first_result ? "" : ",", bench_case->name, bench_case->kernel, case_iterations, repetitions,
+                result.ns_per_op_mean, result.ns_per_op_min, result.ns_per_op_max,
+                result.ns_per_op_variance, result.ops_per_second);
+        }
+
+        fflush(stdout);
+        is_first_result = false;
+    }
+
+    if (format == BENCH_FORMAT_JSON)
+    {
+        puts("\n  ]\n}");
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static uint64_t get_time_ns(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000u + (uint64_t)time.tv_nsec;
+#endif
+}
+
+static void init_inputs(void)
+{
+    srand(42);
+
+    for (int i = 0; i < BENCH_INPUT_COUNT; ++i)
+    {
+        // Entries in [-1, 1] keep repeated products far from overflow and denormals
+        for (int j = 0; j < 4; ++j)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                input_mats[i].value[j][k] = 2.0f * (float)rand() / (float)RAND_MAX - 1.0f;
+            }
+        }
+
+        for (int j = 0; j < 3; ++j)
+        {
+            input_vecs[i].value[j] = 2.0f * (float)rand() / (float)RAND_MAX - 1.0f;
+        }
+
+        // Avoids normalizing a zero vector
+        input_vecs[i].value[2] += input_vecs[i].value[2] >= 0.0f ? 0.1f : -0.1f;
+    }
+
+    for (int i = 0; i < BENCH_POINT_COUNT; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            points_in[i].value[j] = 20.0f * (float)rand() / (float)RAND_MAX - 10.0f;
+            points_in_soa[j][i] = points_in[i].value[j];
+        }
+
+        sphere_radii[i] = (float)rand() / (float)RAND_MAX;
+    }
+
+    // A camera in the middle of the point cloud, so a mix of spheres is culled and kept
+    const Vec3f right = {{1.0f, 0.0f, 0.0f}};
+    const Vec3f up = {{0.0f, 1.0f, 0.0f}};
+    const Vec3f dir = {{0.0f, 0.0f, 1.0f}};
+    const Vec3f pos = {{0.0f, 0.0f, 0.0f}};
+
+    const Mat4f view = mat4f_look_at(&right, &up, &dir, &pos);
+    const Mat4f projection = mat4f_perspective_reverse_z_infinite(1.0f, 1.0f, 0.1f);
+    const Mat4f view_projection = mat4f_product(&projection, &view);
+    frustum_from_matrix(&cull_frustum, &view_projection);
+}
+
+static BenchResult run_bench_case(const BenchCase* const bench_case, const size_t iterations,
+    const int repetitions)
+{
+    const double ops = (double)iterations * (double)bench_case->ops_per_iteration;
+
+    // Warmup: settles clocks and caches and resolves dispatched kernels
+    sink = bench_case->run(iterations / 10 > 0 ? iterations / 10 : 1);
+
+    BenchResult result = {0};
+    result.ns_per_op_min = INFINITY;
+
+    double sum = 0.0;
+    double sum_of_squares = 0.0;
+
+    for (int i = 0; i < repetitions; ++i)
+    {
+        const uint64_t start = get_time_ns();
+        sink = bench_case->run(iterations);
+        const uint64_t end = get_time_ns();
+
+        const double ns_per_op = (double)(end - start) / ops;
+        sum += ns_per_op;
+        sum_of_squares += ns_per_op * ns_per_op;
+
+        if (ns_per_op < result.ns_per_op_min)
+        {
+            result.ns_per_op_min = ns_per_op;
+        }
+        if (ns_per_op > result.ns_per_op_max)
+        {
+            result.ns_per_op_max = ns_per_op;
+        }
+    }
+
+    result.ns_per_op_mean = sum / repetitions;
+    result.ns_per_op_variance = sum_of_squares / repetitions - result.ns_per_op_mean * result.ns_per_op_mean;
+    if (result.ns_per_op_variance < 0.0)
+    {
+        result.ns_per_op_variance = 0.0;
+    }
+    result.ops_per_second = 1e9 / result.ns_per_op_mean;
+
+    return result;
+}
+
+static void print_usage(const char* const program_name)
+{
+    fprintf(stderr, "Usage: %s [--format csv|json] [--iterations N] [--repetitions N] [--filter SUBSTRING]\n",
+        program_name);
+}
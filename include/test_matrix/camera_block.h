@@ -0,0 +1,31 @@
+#ifndef TEST_MATRIX_CAMERA_BLOCK_H
+#define TEST_MATRIX_CAMERA_BLOCK_H
+
+#include "test_matrix/mat4f.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+// Binding point of the Camera uniform block; every program that declares the block uses it, so one
+// buffer range bound here serves all of them
+#define CAMERA_BLOCK_BINDING 0
+
+// Mirrors the std140 Camera block in the shaders. The block is row_major to match Mat4f, so matrices
+// are written as is:
+//
+// layout (std140, binding = 0, row_major) uniform Camera
+// {
+//     mat4 view;
+//     mat4 projection;
+// };
+typedef struct CameraBlock
+{
+    Mat4f view;
+    Mat4f projection;
+} CameraBlock;
+
+static_assert(offsetof(CameraBlock, view) == 0, "CameraBlock.view must be at std140 offset 0");
+static_assert(offsetof(CameraBlock, projection) == 64, "CameraBlock.projection must be at std140 offset 64");
+static_assert(sizeof(CameraBlock) == 128, "CameraBlock must match the std140 size of the Camera block");
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef TEST_MATRIX_CPU_FEATURES_H
+#define TEST_MATRIX_CPU_FEATURES_H
+
+#include <stdbool.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPU_FEATURES_X86 1
+#else
+#define CPU_FEATURES_X86 0
+#endif
+
+// SSE2 is part of the x86-64 baseline, so SSE kernels need no runtime check there
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CPU_FEATURES_SSE2 1
+#else
+#define CPU_FEATURES_SSE2 0
+#endif
+
+// Lets a single function use instructions beyond the baseline the translation unit is compiled for
+#if CPU_FEATURES_X86 && (defined(__GNUC__) || defined(__clang__))
+#define CPU_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define CPU_TARGET_AVX2
+#endif
+
+typedef struct CpuFeatures
+{
+    bool avx2;
+    bool fma;
+} CpuFeatures;
+
+const CpuFeatures* cpu_features_get(void);
+
+#endif
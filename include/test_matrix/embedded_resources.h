@@ -0,0 +1,10 @@
+#ifndef TEST_MATRIX_EMBEDDED_RESOURCES_H
+#define TEST_MATRIX_EMBEDDED_RESOURCES_H
+
+#include <stddef.h>
+
+// resources.pack compiled into the executable by embed_file when TEST_MATRIX_EMBED_RESOURCES is on
+extern const unsigned char embedded_resource_pack[];
+extern const size_t embedded_resource_pack_size;
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef TEST_MATRIX_FILE_MAPPING_H
+#define TEST_MATRIX_FILE_MAPPING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Read-only view of a whole file, paged in by the OS as it is touched
+typedef struct FileMapping
+{
+    const void* data;
+    size_t size;
+
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+} FileMapping;
+
+// Fails on empty files, which can't be mapped
+bool file_mapping_open(FileMapping* const mapping, const char* const path);
+
+void file_mapping_close(FileMapping* const mapping);
+
+#endif
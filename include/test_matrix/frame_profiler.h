@@ -0,0 +1,79 @@
+#ifndef TEST_MATRIX_FRAME_PROFILER_H
+#define TEST_MATRIX_FRAME_PROFILER_H
+
+#include <SDL_stdinc.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FRAME_PROFILER_CAPACITY 1024
+
+#define FRAME_HISTOGRAM_BUCKET_COUNT 16
+#define FRAME_HISTOGRAM_BUCKET_MS 2.0f
+
+typedef enum FrameSection
+{
+    FRAME_SECTION_EVENTS,
+    FRAME_SECTION_SUBMIT,
+    FRAME_SECTION_SWAP,
+    FRAME_SECTION_INFO,
+    // Whole frame, including time not covered by any other section
+    FRAME_SECTION_FRAME,
+    FRAME_SECTION_COUNT
+} FrameSection;
+
+typedef struct FrameSample
+{
+    float section_ms[FRAME_SECTION_COUNT];
+} FrameSample;
+
+// Seqlock guarding one sample of the ring. sequence is 2 * frame + 1 while the frame's sample is being
+// written and 2 * frame + 2 once it is complete, so a reader can tell whether the slot still holds the
+// frame it wants.
+typedef struct FrameProfilerSlot
+{
+    atomic_uint_fast64_t sequence;
+    _Atomic float section_ms[FRAME_SECTION_COUNT];
+} FrameProfilerSlot;
+
+// Fixed-size lock-free ring of per-frame section timings. One thread records; readers on any thread skip
+// samples the writer overwrites while they are being copied instead of seeing them torn.
+typedef struct FrameProfiler
+{
+    FrameProfilerSlot slots[FRAME_PROFILER_CAPACITY];
+    atomic_uint_fast64_t frame_count;
+
+    FrameSample current;
+    Uint64 frame_start;
+    Uint64 section_start;
+} FrameProfiler;
+
+typedef struct FrameStats
+{
+    int sample_count;
+    float p50_ms;
+    float p95_ms;
+    float p99_ms;
+    // The last bucket also counts every sample beyond the histogram's range
+    int histogram[FRAME_HISTOGRAM_BUCKET_COUNT];
+} FrameStats;
+
+void frame_profiler_init(FrameProfiler* const profiler);
+
+void frame_profiler_begin_frame(FrameProfiler* const profiler);
+
+// Attributes the time since the previous mark, or since the frame began, to the section
+void frame_profiler_mark(FrameProfiler* const profiler, const FrameSection section);
+
+void frame_profiler_end_frame(FrameProfiler* const profiler);
+
+void frame_profiler_compute_stats(const FrameProfiler* const profiler, const FrameSection section,
+    FrameStats* const stats);
+
+const char* frame_profiler_section_name(const FrameSection section);
+
+// Writes the recorded samples, oldest first, as CSV
+bool frame_profiler_dump(const FrameProfiler* const profiler, const char* const path);
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef TEST_MATRIX_FRUSTUM_H
+#define TEST_MATRIX_FRUSTUM_H
+
+#include "test_matrix/cpu_features.h"
+#include "test_matrix/mat4f.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRUSTUM_PLANE_COUNT 6
+
+// Planes as (a, b, c, d) with a point inside where a * x + b * y + c * z + d >= 0. Planes are normalized
+// so the left side is a signed distance; a degenerate plane, such as the far plane of an infinite
+// projection, keeps its zero normal and accepts everything.
+typedef struct Frustum
+{
+    float planes[FRUSTUM_PLANE_COUNT][4];
+} Frustum;
+
+// Writes the indices of the spheres that intersect the frustum to visible, in ascending order, and
+// returns their count. visible must have room for count indices.
+typedef size_t (*FrustumCullSpheresFn)(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible);
+
+// Dispatches to the fastest kernel the CPU supports, picked on first use
+size_t frustum_cull_spheres(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible);
+
+// Name of the kernel frustum_cull_spheres dispatches to
+const char* frustum_cull_spheres_kernel_name(void);
+
+// Extracts the planes from a view-projection matrix for clip space depth in [0, w], as set up by
+// glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE); planes are in the space the matrix transforms from
+void frustum_from_matrix(Frustum* const frustum, const Mat4f* const view_projection);
+
+size_t frustum_cull_spheres_scalar(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible);
+
+#if CPU_FEATURES_SSE2
+size_t frustum_cull_spheres_sse(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible);
+
+// Requires cpu_features_get()->avx2 and ->fma
+size_t frustum_cull_spheres_avx2(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible);
+#endif
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TEST_MATRIX_GL_RING_BUFFER_H
+#define TEST_MATRIX_GL_RING_BUFFER_H
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+
+// Frames the CPU may write ahead of the GPU before it has to wait
+#define GL_RING_BUFFER_REGION_COUNT 3
+
+// Persistently mapped buffer split into one region per frame in flight. Each frame writes its
+// streamed data straight into the mapping; a fence per region keeps the CPU from overwriting data
+// the GPU has not consumed yet.
+typedef struct GlRingBuffer
+{
+    GLuint buffer;
+    unsigned char* mapping;
+    GLsizeiptr region_size;
+    GLint alignment;
+
+    GLsync fences[GL_RING_BUFFER_REGION_COUNT];
+    int region;
+    GLsizeiptr region_offset;
+} GlRingBuffer;
+
+bool gl_ring_buffer_create(GlRingBuffer* const ring, const GLsizeiptr region_size);
+
+void gl_ring_buffer_destroy(GlRingBuffer* const ring);
+
+// Moves on to the next region, waiting for the GPU if it is still reading from it
+bool gl_ring_buffer_begin_frame(GlRingBuffer* const ring);
+
+// Returns a pointer to size writable bytes and their offset in ring->buffer, or NULL if the current
+// region is full. Allocations are aligned for use as uniform buffer ranges.
+void* gl_ring_buffer_allocate(GlRingBuffer* const ring, const GLsizeiptr size, GLintptr* const offset);
+
+// Fences the current region after the frame's draw calls that read from it
+void gl_ring_buffer_end_frame(GlRingBuffer* const ring);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef TEST_MATRIX_GLYPH_ATLAS_H
+#define TEST_MATRIX_GLYPH_ATLAS_H
+
+#include <SDL_pixels.h>
+#include <SDL_render.h>
+#include <SDL_ttf.h>
+
+#include <stdbool.h>
+
+#define GLYPH_ATLAS_FIRST_CHAR ' '
+#define GLYPH_ATLAS_LAST_CHAR '~'
+#define GLYPH_ATLAS_CHAR_COUNT (GLYPH_ATLAS_LAST_CHAR - GLYPH_ATLAS_FIRST_CHAR + 1)
+
+typedef struct Glyph
+{
+    SDL_FPoint uv_min;
+    SDL_FPoint uv_max;
+    int width;
+    int height;
+    int advance;
+} Glyph;
+
+// Every printable ASCII glyph of one font rasterized once into a single texture
+typedef struct GlyphAtlas
+{
+    SDL_Texture* texture;
+    int line_skip;
+    Glyph glyphs[GLYPH_ATLAS_CHAR_COUNT];
+} GlyphAtlas;
+
+// Quads referencing a glyph atlas, submitted with a single SDL_RenderGeometry call
+typedef struct TextGeometry
+{
+    SDL_Vertex* vertices;
+    int vertex_count;
+    int vertex_capacity;
+
+    int* indices;
+    int index_count;
+    int index_capacity;
+} TextGeometry;
+
+bool glyph_atlas_create(GlyphAtlas* const atlas, SDL_Renderer* const renderer, TTF_Font* const font);
+
+void glyph_atlas_destroy(GlyphAtlas* const atlas);
+
+bool glyph_atlas_append_text(const GlyphAtlas* const atlas, TextGeometry* const geometry,
+    const char* const text, const SDL_Color color, const int x, const int y);
+
+bool glyph_atlas_draw(const GlyphAtlas* const atlas, SDL_Renderer* const renderer,
+    const TextGeometry* const geometry);
+
+bool text_geometry_append(TextGeometry* const geometry, const TextGeometry* const other);
+
+void text_geometry_clear(TextGeometry* const geometry);
+
+void text_geometry_destroy(TextGeometry* const geometry);
+
+#endif
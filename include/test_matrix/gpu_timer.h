@@ -0,0 +1,34 @@
+#ifndef TEST_MATRIX_GPU_TIMER_H
+#define TEST_MATRIX_GPU_TIMER_H
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+
+// Frames a query may stay in flight before its slot is reused
+#define GPU_TIMER_QUERY_COUNT 3
+
+// Ring of GL_TIME_ELAPSED queries whose results are read back without stalling the pipeline
+typedef struct GpuTimer
+{
+    GLuint queries[GPU_TIMER_QUERY_COUNT];
+    bool is_query_pending[GPU_TIMER_QUERY_COUNT];
+    bool is_query_active;
+    int next_query;
+
+    double last_gpu_ms;
+} GpuTimer;
+
+void gpu_timer_create(GpuTimer* const timer);
+
+void gpu_timer_destroy(GpuTimer* const timer);
+
+// Skips timing the frame instead of waiting if the next slot's query has not finished yet
+void gpu_timer_begin(GpuTimer* const timer);
+
+void gpu_timer_end(GpuTimer* const timer);
+
+// Collects every finished query; returns true if last_gpu_ms was updated
+bool gpu_timer_poll(GpuTimer* const timer);
+
+#endif
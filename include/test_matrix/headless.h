@@ -0,0 +1,33 @@
+#ifndef TEST_MATRIX_HEADLESS_H
+#define TEST_MATRIX_HEADLESS_H
+
+#include "glad/glad.h"
+
+#include <EGL/egl.h>
+
+#include <stdbool.h>
+
+// Window-less OpenGL context rendering into its own framebuffer object
+typedef struct HeadlessContext
+{
+    EGLDisplay display;
+    EGLContext context;
+    EGLSurface surface;
+
+    GLuint framebuffer;
+    // Color only; the scene renders into its own framebuffer with depth and is blitted here
+    GLuint color_renderbuffer;
+
+    int width;
+    int height;
+} HeadlessContext;
+
+// Creates the context, makes it current, loads GL functions and binds the framebuffer
+bool headless_context_create(HeadlessContext* const headless, const int width, const int height);
+
+void headless_context_destroy(HeadlessContext* const headless);
+
+// eglGetProcAddress in the form glad's loader expects
+void* headless_get_proc_address(const char* const name);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef TEST_MATRIX_MAT4F_H
+#define TEST_MATRIX_MAT4F_H
+
+#include "test_matrix/cpu_features.h"
+#include "test_matrix/vec3f.h"
+
+#include <stdalign.h>
+#include <stddef.h>
+
+// Row-major; each row is 16-byte aligned so it loads with a single SSE instruction
+typedef struct Mat4f
+{
+    alignas(16) float value[4][4];
+} Mat4f;
+
+typedef Mat4f (*Mat4fProductFn)(const Mat4f* const mat1, const Mat4f* const mat2);
+
+typedef void (*Mat4fTransformPointsFn)(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out,
+    const size_t count);
+
+typedef void (*Mat4fTransformPointsSoaFn)(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count);
+
+// Dispatches to the fastest kernel the CPU supports, picked on first use
+Mat4f mat4f_product(const Mat4f* const mat1, const Mat4f* const mat2);
+
+// Computes out[i] = mat * (in[i], 1) without the perspective divide; in and out may be the same array.
+// Dispatches like mat4f_product.
+void mat4f_transform_points(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out, const size_t count);
+
+// Same as mat4f_transform_points for points stored as separate x, y and z arrays
+void mat4f_transform_points_soa(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count);
+
+// Names of the kernels mat4f_product, mat4f_transform_points and mat4f_transform_points_soa dispatch to
+const char* mat4f_product_kernel_name(void);
+
+const char* mat4f_transform_points_kernel_name(void);
+
+const char* mat4f_transform_points_soa_kernel_name(void);
+
+Mat4f mat4f_transpose(const Mat4f* const mat);
+
+// Projections for a view space with x right, y up and the camera looking down +z, as mat4f_look_at
+// produces. fov_y is in radians.
+
+// Depth from -1 at the near plane to 1 at the far plane, for the default
+// glClipControl(GL_LOWER_LEFT, GL_NEGATIVE_ONE_TO_ONE)
+Mat4f mat4f_perspective(const float fov_y, const float aspect, const float near_z, const float far_z);
+
+// Reverse-Z: depth from 1 at the near plane to 0 at the far plane, for
+// glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE) with GL_GREATER depth testing. Float depth keeps nearly
+// uniform precision over the whole range this way.
+Mat4f mat4f_perspective_reverse_z(const float fov_y, const float aspect, const float near_z,
+    const float far_z);
+
+// Reverse-Z with the far plane at infinity; depth approaches 0 as distance grows
+Mat4f mat4f_perspective_reverse_z_infinite(const float fov_y, const float aspect, const float near_z);
+
+// View matrix for a camera at pos with the given orthonormal basis; equal to the product of the basis
+// rotation and the translation by -pos, written out directly
+Mat4f mat4f_look_at(const Vec3f* const right, const Vec3f* const up, const Vec3f* const dir, const Vec3f* const pos);
+
+Mat4f mat4f_product_scalar(const Mat4f* const mat1, const Mat4f* const mat2);
+
+void mat4f_transform_points_scalar(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out,
+    const size_t count);
+
+void mat4f_transform_points_soa_scalar(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count);
+
+#if CPU_FEATURES_SSE2
+Mat4f mat4f_product_sse(const Mat4f* const mat1, const Mat4f* const mat2);
+
+void mat4f_transform_points_sse(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out,
+    const size_t count);
+
+void mat4f_transform_points_soa_sse(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count);
+
+// The AVX2 kernels require cpu_features_get()->avx2 and ->fma
+
+Mat4f mat4f_product_avx2(const Mat4f* const mat1, const Mat4f* const mat2);
+
+void mat4f_transform_points_soa_avx2(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count);
+#endif
+
+#endif
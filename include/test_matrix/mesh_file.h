@@ -0,0 +1,57 @@
+#ifndef TEST_MATRIX_MESH_FILE_H
+#define TEST_MATRIX_MESH_FILE_H
+
+#include "test_matrix/file_mapping.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// "TMMS" read as a little-endian uint32_t; files are always little-endian
+#define MESH_FILE_MAGIC 0x534D4D54u
+#define MESH_FILE_VERSION 1u
+
+// Offset alignment of the vertex and index blocks, so both can be handed to GL straight from a mapping
+#define MESH_FILE_BLOCK_ALIGNMENT 64u
+
+// Same layout as SceneVertex
+typedef struct MeshFileVertex
+{
+    float position[3];
+    float color[3];
+} MeshFileVertex;
+
+// Starts the file, followed by vertex_count MeshFileVertex at vertex_offset and index_count uint32_t
+// triangle list indices at index_offset
+typedef struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+} MeshFileHeader;
+
+// A mapped mesh file, or one already in memory, whose blocks are used in place
+typedef struct MeshFile
+{
+    // Unused for meshes opened from memory
+    FileMapping mapping;
+    const MeshFileVertex* vertices;
+    uint32_t vertex_count;
+    const uint32_t* indices;
+    uint32_t index_count;
+} MeshFile;
+
+// Maps the file and checks its header, block bounds and indices
+bool mesh_file_open(MeshFile* const mesh, const char* const path);
+
+// Uses a mesh file that is already in memory, e.g. inside a resource pack; data must be aligned to
+// MESH_FILE_BLOCK_ALIGNMENT and outlive the mesh. name is only used for error messages.
+bool mesh_file_open_memory(MeshFile* const mesh, const void* const data, const size_t size,
+    const char* const name);
+
+void mesh_file_close(MeshFile* const mesh);
+
+#endif
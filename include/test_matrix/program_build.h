@@ -0,0 +1,54 @@
+#ifndef TEST_MATRIX_PROGRAM_BUILD_H
+#define TEST_MATRIX_PROGRAM_BUILD_H
+
+#include "glad/glad.h"
+#include "test_matrix/program_cache.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// KHR_parallel_shader_compile, which the bundled glad loader predates
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+#define PROGRAM_BUILD_SHADER_CAPACITY 3
+
+typedef enum ProgramBuildStatus
+{
+    PROGRAM_BUILD_PENDING,
+    PROGRAM_BUILD_DONE,
+    PROGRAM_BUILD_FAILED
+} ProgramBuildStatus;
+
+// A program whose shaders have been handed to the driver to compile and link in the background
+typedef struct ProgramBuild
+{
+    GLuint program;
+    GLuint shaders[PROGRAM_BUILD_SHADER_CAPACITY];
+    // Only used for error messages, so they must outlive the build
+    const char* names[PROGRAM_BUILD_SHADER_CAPACITY];
+    int shader_count;
+
+    ProgramCacheKey cache_key;
+    bool is_cached;
+    ProgramBuildStatus status;
+} ProgramBuild;
+
+// Turns on KHR_parallel_shader_compile, or its ARB twin, if the current context has it. Without
+// either, builds still work but finish inside the first program_build_poll.
+void program_build_init(GLADloadproc load);
+
+// Loads the program from the cache, or submits every shader's compile and the link without waiting for
+// any of them. Fails only if there are more shaders than PROGRAM_BUILD_SHADER_CAPACITY.
+bool program_build_begin(ProgramBuild* const build, const ProgramCache* const cache,
+    const char* const* const sources, const GLenum* const types, const char* const* const names,
+    const int shader_count);
+
+// Never blocks while the driver reports the build as in progress. Once done, build->program is linked
+// and belongs to the caller; on failure the compile and link logs have been printed.
+ProgramBuildStatus program_build_poll(ProgramBuild* const build, const ProgramCache* const cache);
+
+// Deletes whatever the build still owns, finished or not
+void program_build_cancel(ProgramBuild* const build);
+
+#endif
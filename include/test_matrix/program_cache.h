@@ -0,0 +1,41 @@
+#ifndef TEST_MATRIX_PROGRAM_CACHE_H
+#define TEST_MATRIX_PROGRAM_CACHE_H
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Linked program binaries on disk, one file per program. A file is found by the program's shader names
+// and holds a hash of their sources and of the driver that built it, so a driver update or a shader edit
+// misses the cache and the rebuilt program replaces the stale binary.
+typedef struct ProgramCache
+{
+    char* dir;
+    uint64_t driver_hash;
+} ProgramCache;
+
+typedef struct ProgramCacheKey
+{
+    uint64_t name_hash;
+    uint64_t source_hash;
+} ProgramCacheKey;
+
+// dir must end with a path separator, like SDL_GetPrefPath's result. Leaves the cache disabled if the
+// driver can't save program binaries.
+bool program_cache_create(ProgramCache* const cache, const char* const dir);
+
+void program_cache_destroy(ProgramCache* const cache);
+
+ProgramCacheKey program_cache_key(const ProgramCache* const cache, const char* const* const names,
+    const char* const* const sources, const int shader_count);
+
+// Returns a linked program, or 0 if nothing usable is cached under key
+GLuint program_cache_load(const ProgramCache* const cache, const ProgramCacheKey* const key);
+
+// Must be called before linking a program that will be stored
+void program_cache_prepare(const ProgramCache* const cache, const GLuint program);
+
+void program_cache_store(const ProgramCache* const cache, const ProgramCacheKey* const key, const GLuint program);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef TEST_MATRIX_RESOURCE_PACK_H
+#define TEST_MATRIX_RESOURCE_PACK_H
+
+#include "test_matrix/file_mapping.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// "TMPK" read as a little-endian uint32_t; packs are always little-endian
+#define RESOURCE_PACK_MAGIC 0x4B504D54u
+#define RESOURCE_PACK_VERSION 1u
+
+// Offset alignment of every resource's data, which keeps mesh file blocks aligned inside the pack
+#define RESOURCE_PACK_DATA_ALIGNMENT 64u
+
+// Starts the pack, followed by slot_count slots at slots_offset, the resource names at names_offset and
+// the resources' data
+typedef struct ResourcePackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    // A power of two, at least twice entry_count so probe sequences stay short
+    uint32_t slot_count;
+    uint32_t entry_count;
+    uint64_t slots_offset;
+    uint64_t names_offset;
+} ResourcePackHeader;
+
+// Open addressing hash table slot, found by linear probing from name_hash & (slot_count - 1)
+typedef struct ResourcePackSlot
+{
+    uint64_t name_hash;
+    uint64_t data_offset;
+    // Not counting the zero byte every resource is followed by, so text can be used as a C string
+    uint64_t data_size;
+    uint32_t name_offset;
+    // Zero for an empty slot
+    uint32_t name_length;
+} ResourcePackSlot;
+
+typedef struct ResourcePack
+{
+    // Unused for packs opened from memory
+    FileMapping mapping;
+    const unsigned char* data;
+    size_t size;
+    const ResourcePackSlot* slots;
+    uint32_t slot_count;
+    const unsigned char* names;
+} ResourcePack;
+
+// A resource's bytes inside the pack's mapping, valid until the pack is closed
+typedef struct Resource
+{
+    const void* data;
+    size_t size;
+} Resource;
+
+// FNV-1a, shared by the pack tool and the lookup
+static inline uint64_t resource_pack_hash_name(const char* const name, const size_t length)
+{
+    uint64_t hash = 0xCBF29CE484222325u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 0x100000001B3u;
+    }
+
+    return hash;
+}
+
+// Maps the pack and checks its header and every slot, so lookups can trust the offsets
+bool resource_pack_open(ResourcePack* const pack, const char* const path);
+
+// Uses a pack that is already in memory, e.g. compiled into the executable; data must be aligned to
+// RESOURCE_PACK_DATA_ALIGNMENT and outlive the pack. name is only used for error messages.
+bool resource_pack_open_memory(ResourcePack* const pack, const void* const data, const size_t size,
+    const char* const name);
+
+void resource_pack_close(ResourcePack* const pack);
+
+// Returns false if the pack has no resource with that name
+bool resource_pack_find(const ResourcePack* const pack, const char* const name, Resource* const resource);
+
+#endif
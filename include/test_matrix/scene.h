@@ -0,0 +1,143 @@
+#ifndef TEST_MATRIX_SCENE_H
+#define TEST_MATRIX_SCENE_H
+
+#include "glad/glad.h"
+#include "test_matrix/frustum.h"
+#include "test_matrix/gl_ring_buffer.h"
+#include "test_matrix/mat4f.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Vertex attribute bindings of the scene's VAO
+#define SCENE_VERTEX_BUFFER_BINDING 0
+#define SCENE_INSTANCE_BUFFER_BINDING 1
+
+// Shader storage bindings and uniform locations shared with cull.comp and shader_gpu_cull.vert
+#define SCENE_BOUNDS_STORAGE_BINDING 0
+#define SCENE_INSTANCE_MESH_STORAGE_BINDING 1
+#define SCENE_COMMAND_STORAGE_BINDING 2
+#define SCENE_VISIBLE_INSTANCE_STORAGE_BINDING 3
+#define SCENE_MODEL_STORAGE_BINDING 4
+#define SCENE_CULL_PLANES_LOCATION 0
+#define SCENE_CULL_OBJECT_COUNT_LOCATION 6
+#define SCENE_CULL_GROUP_SIZE 64
+
+typedef struct SceneVertex
+{
+    float position[3];
+    float color[3];
+} SceneVertex;
+
+// Layout glMultiDrawElementsIndirect reads its commands in
+typedef struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+} DrawElementsIndirectCommand;
+
+// Range of one mesh within the shared vertex and index buffers
+typedef struct SceneMesh
+{
+    GLuint first_index;
+    GLuint index_count;
+    GLint base_vertex;
+    // Bounding sphere around the mesh's origin
+    float radius;
+
+    // Caller's data, uploaded from in place
+    const SceneVertex* vertices;
+    int vertex_count;
+    const GLuint* indices;
+} SceneMesh;
+
+typedef struct SceneObject
+{
+    Mat4f model;
+    int mesh;
+} SceneObject;
+
+// Many meshes packed into one vertex buffer and one index buffer, drawn with a single
+// glMultiDrawElementsIndirect call. Objects are grouped by mesh, so each mesh is one indirect command
+// whose instances are that mesh's visible objects, and base_instance selects their model matrices.
+typedef struct Scene
+{
+    // Totals over all meshes
+    int vertex_count;
+    int index_count;
+
+    SceneMesh* meshes;
+    int mesh_count;
+    int mesh_capacity;
+
+    // In the order they were added
+    SceneObject* objects;
+    int object_count;
+    int object_capacity;
+
+    // Filled by scene_upload: model matrices grouped by mesh and transposed for GLSL, their world space
+    // bounding spheres as separate arrays for SIMD culling, and one command per mesh covering all of
+    // its objects
+    Mat4f* instance_models;
+    float* bounds_x;
+    float* bounds_y;
+    float* bounds_z;
+    float* bounds_radius;
+    DrawElementsIndirectCommand* commands;
+
+    // Culling output, rewritten every frame
+    uint32_t* visible_instances;
+
+    GLuint vertex_buffer;
+    GLuint index_buffer;
+    GLuint vao;
+
+    // Only created for GPU culling. Bounds and models stay on the GPU; every frame a compute shader
+    // rebuilds the commands' instance counts and the visible instance list the vertex shader reads
+    // models through.
+    bool is_gpu_culled;
+    GLuint bounds_buffer;
+    GLuint instance_mesh_buffer;
+    GLuint model_buffer;
+    GLuint command_buffer;
+    GLuint visible_instance_buffer;
+
+    // A copy of the culled commands per ring buffer region, read once the region's fence has passed
+    GLuint readback_buffer;
+    const DrawElementsIndirectCommand* readback_mapping;
+} Scene;
+
+// Returns the new mesh's index, or -1 on failure. The vertices and indices aren't copied and must stay
+// valid until scene_upload, so they can come straight from a mapped file.
+int scene_add_mesh(Scene* const scene, const SceneVertex* const vertices, const int vertex_count,
+    const GLuint* const indices, const int index_count);
+
+bool scene_add_object(Scene* const scene, const int mesh, const Mat4f* const model);
+
+// Creates the GL buffers and VAO; meshes and objects can't be added afterwards. With use_gpu_culling the
+// scene is drawn with scene_cull_gpu and scene_draw_gpu_culled instead of scene_draw.
+bool scene_upload(Scene* const scene, const bool use_gpu_culling);
+
+// Most bytes scene_draw allocates from the ring buffer in one frame, not counting alignment; nothing is
+// streamed when the scene is culled on the GPU
+GLsizeiptr scene_get_frame_stream_size(const Scene* const scene);
+
+// Culls the objects against the frustum, then streams the visible objects' models and the indirect
+// commands through the ring buffer's current frame and draws them. Reports the number of objects drawn.
+bool scene_draw(Scene* const scene, GlRingBuffer* const ring, const Frustum* const frustum,
+    int* const visible_count);
+
+// Resets the commands and runs cull_program over every object. The visible count reported is the one
+// from the last frame that used the ring buffer's current region, as reading this frame's would stall.
+void scene_cull_gpu(Scene* const scene, const GLuint cull_program, const GlRingBuffer* const ring,
+    const Frustum* const frustum, int* const visible_count);
+
+// Draws what the last scene_cull_gpu left visible; the current program must read models by instance
+void scene_draw_gpu_culled(const Scene* const scene);
+
+void scene_destroy(Scene* const scene);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef TEST_MATRIX_SHADER_WATCHER_H
+#define TEST_MATRIX_SHADER_WATCHER_H
+
+#include <stdbool.h>
+
+// Non-blocking inotify watch on a shader directory. Without inotify the watcher is inert and never
+// reports changes.
+typedef struct ShaderWatcher
+{
+    int fd;
+} ShaderWatcher;
+
+bool shader_watcher_create(ShaderWatcher* const watcher, const char* const dir);
+
+void shader_watcher_destroy(ShaderWatcher* const watcher);
+
+// Drains the pending events; returns true if a .vert, .frag or .comp file in the directory was written
+// or moved in since the last poll
+bool shader_watcher_poll(ShaderWatcher* const watcher);
+
+#endif
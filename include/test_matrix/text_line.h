@@ -0,0 +1,44 @@
+#ifndef TEST_MATRIX_TEXT_LINE_H
+#define TEST_MATRIX_TEXT_LINE_H
+
+#include "test_matrix/glyph_atlas.h"
+
+#include <SDL_pixels.h>
+
+#include <stdbool.h>
+
+#define TEXT_LINE_MAX_VALUES 16
+
+// Everything a text line's appearance depends on besides its constant label
+typedef struct TextLineKey
+{
+    float values[TEXT_LINE_MAX_VALUES];
+    int value_count;
+    SDL_Color color;
+    int x;
+    int y;
+} TextLineKey;
+
+// Overlay line that keeps its last laid out geometry and is only rebuilt when its key changes
+typedef struct TextLine
+{
+    TextLineKey key;
+    bool is_valid;
+    TextGeometry geometry;
+} TextLine;
+
+// Keeps at most TEXT_LINE_MAX_VALUES values, with -0.0f stored as 0.0f; text built from a key should
+// format key->values so it doesn't depend on which zero came in
+void text_line_key_init(TextLineKey* const key, const float* const values, const int value_count,
+    const SDL_Color color, const int x, const int y);
+
+bool text_line_is_dirty(const TextLine* const line, const TextLineKey* const key);
+
+bool text_line_update(TextLine* const line, const GlyphAtlas* const atlas,
+    const TextLineKey* const key, const char* const text);
+
+bool text_line_append(const TextLine* const line, TextGeometry* const geometry);
+
+void text_line_destroy(TextLine* const line);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TEST_MATRIX_VEC3F_H
+#define TEST_MATRIX_VEC3F_H
+
+#include <math.h>
+
+typedef struct Vec3f
+{
+    float value[3];
+} Vec3f;
+
+static inline float vec3f_get_length(const Vec3f* const vec)
+{
+    return sqrtf(vec->value[0] * vec->value[0] + vec->value[1] * vec->value[1] + vec->value[2] * vec->value[2]);
+}
+
+static inline float vec3f_dot(const Vec3f* const vec1, const Vec3f* const vec2)
+{
+    return vec1->value[0] * vec2->value[0] + vec1->value[1] * vec2->value[1] + vec1->value[2] * vec2->value[2];
+}
+
+static inline Vec3f vec3f_normalize(const Vec3f* const vec)
+{
+    const float length = vec3f_get_length(vec);
+
+    return (Vec3f){{vec->value[0] / length, vec->value[1] / length, vec->value[2] / length}};
+}
+
+static inline Vec3f vec3f_cross(const Vec3f* const vec1, const Vec3f* const vec2)
+{
+    return (Vec3f){{
+        vec1->value[1] * vec2->value[2] - vec1->value[2] * vec2->value[1],
+        vec1->value[2] * vec2->value[0] - vec1->value[0] * vec2->value[2],
+        vec1->value[0] * vec2->value[1] - vec1->value[1] * vec2->value[0]
+    }};
+}
+
+#endif
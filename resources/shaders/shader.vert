@@ -1,17 +1,19 @@
-#version 460 core
+#version 450 core
 
 layout (location = 0) in vec3 in_position;
 layout (location = 1) in vec3 in_color;
+layout (location = 2) in mat4 in_model;
 
 out vec3 color;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140, binding = 0, row_major) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+};
 
 void main()
 {
-    // gl_Position = projection * view * model * vec4(in_position, 1.0);
-    gl_Position = view * vec4(in_position, 1.0);
+    gl_Position = projection * view * in_model * vec4(in_position, 1.0);
     color = in_color;
 }
@@ -0,0 +1,24 @@
+#version 450 core
+
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_color;
+layout (location = 2) in uint in_instance;
+
+out vec3 color;
+
+layout (std140, binding = 0, row_major) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+};
+
+layout (std430, binding = 4) readonly buffer InstanceModels
+{
+    mat4 instance_models[];
+};
+
+void main()
+{
+    gl_Position = projection * view * instance_models[in_instance] * vec4(in_position, 1.0);
+    color = in_color;
+}
@@ -0,0 +1,69 @@
+#include "test_matrix/cpu_features.h"
+
+#include <stdbool.h>
+
+#if CPU_FEATURES_X86 && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+static CpuFeatures cpu_features;
+static bool is_cpu_features_detected = false;
+
+static void detect_cpu_features(CpuFeatures* const features);
+
+const CpuFeatures* cpu_features_get(void)
+{
+    if (!is_cpu_features_detected)
+    {
+        detect_cpu_features(&cpu_features);
+        is_cpu_features_detected = true;
+    }
+
+    return &cpu_features;
+}
+
+#if CPU_FEATURES_X86 && (defined(__GNUC__) || defined(__clang__))
+
+static void detect_cpu_features(CpuFeatures* const features)
+{
+    // Also accounts for whether the OS saves the AVX register state
+    __builtin_cpu_init();
+    features->avx2 = __builtin_cpu_supports("avx2");
+    features->fma = __builtin_cpu_supports("fma");
+}
+
+#elif CPU_FEATURES_X86 && defined(_MSC_VER)
+
+static void detect_cpu_features(CpuFeatures* const features)
+{
+    int info[4];
+
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    features->fma = (info[2] & (1 << 12)) != 0;
+
+    const bool is_osxsave_supported = (info[2] & (1 << 27)) != 0;
+    const bool is_avx_state_enabled = is_osxsave_supported && (_xgetbv(0) & 0x6) == 0x6;
+
+    features->avx2 = false;
+    if (max_leaf >= 7 && is_avx_state_enabled)
+    {
+        __cpuidex(info, 7, 0);
+        features->avx2 = (info[1] & (1 << 5)) != 0;
+    }
+
+    features->fma = features->fma && is_avx_state_enabled;
+}
+
+#else
+
+static void detect_cpu_features(CpuFeatures* const features)
+{
+    features->avx2 = false;
+    features->fma = false;
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include "test_matrix/file_mapping.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+
+bool file_mapping_open(FileMapping* const mapping, const char* const path)
+{
+    memset(mapping, 0, sizeof(*mapping));
+
+    const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+    mapping->file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || (unsigned long long)size.QuadPart > SIZE_MAX)
+    {
+        fprintf(stderr, "Failed to get a mappable size for %s\n", path);
+        file_mapping_close(mapping);
+        return false;
+    }
+    mapping->size = (size_t)size.QuadPart;
+
+    mapping->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping->mapping == NULL)
+    {
+        fprintf(stderr, "Failed to create file mapping for %s\n", path);
+        file_mapping_close(mapping);
+        return false;
+    }
+
+    mapping->data = MapViewOfFile(mapping->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (mapping->data == NULL)
+    {
+        fprintf(stderr, "Failed to map %s\n", path);
+        file_mapping_close(mapping);
+        return false;
+    }
+
+    return true;
+}
+
+void file_mapping_close(FileMapping* const mapping)
+{
+    if (mapping->data != NULL)
+    {
+        UnmapViewOfFile(mapping->data);
+    }
+
+    if (mapping->mapping != NULL)
+    {
+        CloseHandle(mapping->mapping);
+    }
+
+    if (mapping->file != NULL)
+    {
+        CloseHandle(mapping->file);
+    }
+
+    memset(mapping, 0, sizeof(*mapping));
+}
+
+#else
+
+bool file_mapping_open(FileMapping* const mapping, const char* const path)
+{
+    memset(mapping, 0, sizeof(*mapping));
+
+    const int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        fprintf(stderr, "Failed to get a mappable size for %s\n", path);
+        close(file);
+        return false;
+    }
+
+    void* const data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps its own reference to the file
+    close(file);
+
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to map %s\n", path);
+        return false;
+    }
+
+    mapping->data = data;
+    mapping->size = (size_t)file_stat.st_size;
+
+    return true;
+}
+
+void file_mapping_close(FileMapping* const mapping)
+{
+    if (mapping->data != NULL)
+    {
+        munmap((void*)mapping->data, mapping->size);
+    }
+
+    memset(mapping, 0, sizeof(*mapping));
+}
+
+#endif
@@ -0,0 +1,226 @@
+#include "test_matrix/frame_profiler.h"
+
+#include <SDL_stdinc.h>
+#include <SDL_timer.h>
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* const section_names[FRAME_SECTION_COUNT] = {
+    "events",
+    "submit",
+    "swap",
+    "info",
+    "frame"
+};
+
+static bool read_sample(const FrameProfiler* const profiler, const uint_fast64_t frame,
+    FrameSample* const sample);
+
+static float counter_to_ms(const Uint64 ticks);
+
+static int compare_floats(const void* const lhs, const void* const rhs);
+
+static float get_percentile(const float* const sorted, const int count, const float percentile);
+
+void frame_profiler_init(FrameProfiler* const profiler)
+{
+    for (int i = 0; i < FRAME_PROFILER_CAPACITY; ++i)
+    {
+        atomic_init(&profiler->slots[i].sequence, 0);
+        for (int j = 0; j < FRAME_SECTION_COUNT; ++j)
+        {
+            atomic_init(&profiler->slots[i].section_ms[j], 0.0f);
+        }
+    }
+
+    memset(&profiler->current, 0, sizeof(profiler->current));
+    profiler->frame_start = 0;
+    profiler->section_start = 0;
+    atomic_init(&profiler->frame_count, 0);
+}
+
+void frame_profiler_begin_frame(FrameProfiler* const profiler)
+{
+    memset(&profiler->current, 0, sizeof(profiler->current));
+    profiler->frame_start = SDL_GetPerformanceCounter();
+    profiler->section_start = profiler->frame_start;
+}
+
+void frame_profiler_mark(FrameProfiler* const profiler, const FrameSection section)
+{
+    const Uint64 now = SDL_GetPerformanceCounter();
+    profiler->current.section_ms[section] += counter_to_ms(now - profiler->section_start);
+    profiler->section_start = now;
+}
+
+void frame_profiler_end_frame(FrameProfiler* const profiler)
+{
+    profiler->current.section_ms[FRAME_SECTION_FRAME] =
+        counter_to_ms(SDL_GetPerformanceCounter() - profiler->frame_start);
+
+    const uint_fast64_t frame = atomic_load_explicit(&profiler->frame_count, memory_order_relaxed);
+    FrameProfilerSlot* const slot = &profiler->slots[frame % FRAME_PROFILER_CAPACITY];
+
+    // The fence keeps the section stores from becoming visible before the slot is marked as being written
+    atomic_store_explicit(&slot->sequence, 2 * frame + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (int i = 0; i < FRAME_SECTION_COUNT; ++i)
+    {
+        atomic_store_explicit(&slot->section_ms[i], profiler->current.section_ms[i], memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&slot->sequence, 2 * frame + 2, memory_order_release);
+    atomic_store_explicit(&profiler->frame_count, frame + 1, memory_order_release);
+}
+
+void frame_profiler_compute_stats(const FrameProfiler* const profiler, const FrameSection section,
+    FrameStats* const stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    const uint_fast64_t frame_count = atomic_load_explicit(
+        &profiler->frame_count, memory_order_acquire);
+    const uint_fast64_t first_frame = frame_count > FRAME_PROFILER_CAPACITY ? frame_count - FRAME_PROFILER_CAPACITY : 0;
+
+    float sorted[FRAME_PROFILER_CAPACITY];
+    int sample_count = 0;
+    for (uint_fast64_t frame = first_frame; frame < frame_count; ++frame)
+    {
+        FrameSample sample;
+        if (!read_sample(profiler, frame, &sample))
+        {
+            continue;
+        }
+
+        const float ms = sample.section_ms[section];
+        sorted[sample_count++] = ms;
+
+        int bucket = (int)(ms / FRAME_HISTOGRAM_BUCKET_MS);
+        if (bucket >= FRAME_HISTOGRAM_BUCKET_COUNT)
+        {
+            bucket = FRAME_HISTOGRAM_BUCKET_COUNT - 1;
+        }
+        ++stats->histogram[bucket];
+    }
+
+    if (sample_count == 0)
+    {
+        return;
+    }
+
+    qsort(sorted, sample_count, sizeof(float), compare_floats);
+
+    stats->sample_count = sample_count;
+    stats->p50_ms = get_percentile(sorted, sample_count, 0.50f);
+    stats->p95_ms = get_percentile(sorted, sample_count, 0.95f);
+    stats->p99_ms = get_percentile(sorted, sample_count, 0.99f);
+}
+
+const char* frame_profiler_section_name(const FrameSection section)
+{
+    return section_names[section];
+}
+
+bool frame_profiler_dump(const FrameProfiler* const profiler, const char* const path)
+{
+    FILE* const file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    fputs("frame", file);
+    for (int i = 0; i < FRAME_SECTION_COUNT; ++i)
+    {
+        fprintf(file, ",%s_ms", section_names[i]);
+    }
+    fputc('\n', file);
+
+    const uint_fast64_t frame_count = atomic_load_explicit(
+        &profiler->frame_count, memory_order_acquire);
+    const uint_fast64_t first_frame = frame_count > FRAME_PROFILER_CAPACITY ? frame_count - FRAME_PROFILER_CAPACITY : 0;
+
+    for (uint_fast64_t frame = first_frame; frame < frame_count; ++frame)
+    {
+        FrameSample sample;
+        if (!read_sample(profiler, frame, &sample))
+        {
+            continue;
+        }
+
+        fprintf(file, "%llu", (unsigned long long)frame);
+        for (int i = 0; i < FRAME_SECTION_COUNT; ++i)
+        {
+            fprintf(file, ",%.4f", sample.section_ms[i]);
+        }
+        fputc('\n', file);
+    }
+
+    const bool success = !ferror(file);
+    fclose(file);
+
+    if (!success)
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+    }
+
+    return success;
+}
+
+// A frame whose slot has been overwritten since, or is being overwritten right now, is gone for good, so
+// there is nothing to retry
+static bool read_sample(const FrameProfiler* const profiler, const uint_fast64_t frame,
+    FrameSample* const sample)
+{
+    const FrameProfilerSlot* const slot = &profiler->slots[frame % FRAME_PROFILER_CAPACITY];
+    const uint_fast64_t sequence = 2 * frame + 2;
+
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != sequence)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < FRAME_SECTION_COUNT; ++i)
+    {
+        sample->section_ms[i] = atomic_load_explicit(&slot->section_ms[i], memory_order_relaxed);
+    }
+
+    // The fence keeps the section loads from moving past the second sequence check
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->sequence, memory_order_relaxed) == sequence;
+}
+
+static float counter_to_ms(const Uint64 ticks)
+{
+    return (float)((double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency());
+}
+
+static int compare_floats(const void* const lhs, const void* const rhs)
+{
+    const float a = *(const float*)lhs;
+    const float b = *(const float*)rhs;
+    return (a > b) - (a < b);
+}
+
+static float get_percentile(const float* const sorted, const int count, const float percentile)
+{
+    // Nearest-rank method
+    int rank = (int)(percentile * (float)count + 0.999f);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    if (rank > count)
+    {
+        rank = count;
+    }
+
+    return sorted[rank - 1];
+}
@@ -0,0 +1,222 @@
+#include "test_matrix/frustum.h"
+
+#include "test_matrix/cpu_features.h"
+#include "test_matrix/mat4f.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if CPU_FEATURES_SSE2
+#include <immintrin.h>
+#endif
+
+static void frustum_select_kernels(void);
+
+static size_t frustum_cull_spheres_resolve(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible);
+
+static FrustumCullSpheresFn frustum_cull_spheres_kernel = frustum_cull_spheres_resolve;
+
+static const char* frustum_cull_spheres_kernel_name_value = NULL;
+
+size_t frustum_cull_spheres(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible)
+{
+    return frustum_cull_spheres_kernel(frustum, x, y, z, radius, count, visible);
+}
+
+const char* frustum_cull_spheres_kernel_name(void)
+{
+    if (frustum_cull_spheres_kernel_name_value == NULL)
+    {
+        frustum_select_kernels();
+    }
+
+    return frustum_cull_spheres_kernel_name_value;
+}
+
+void frustum_from_matrix(Frustum* const frustum, const Mat4f* const view_projection)
+{
+    const float (*const m)[4] = view_projection->value;
+
+    // -w <= x <= w, -w <= y <= w and 0 <= z <= w, each rearranged into a plane of the form above
+    for (int i = 0; i < 4; ++i)
+    {
+        frustum->planes[0][i] = m[3][i] + m[0][i];
+        frustum->planes[1][i] = m[3][i] - m[0][i];
+        frustum->planes[2][i] = m[3][i] + m[1][i];
+        frustum->planes[3][i] = m[3][i] - m[1][i];
+        frustum->planes[4][i] = m[2][i];
+        frustum->planes[5][i] = m[3][i] - m[2][i];
+    }
+
+    for (int i = 0; i < FRUSTUM_PLANE_COUNT; ++i)
+    {
+        float* const plane = frustum->planes[i];
+
+        const float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            plane[0] /= length;
+            plane[1] /= length;
+            plane[2] /= length;
+            plane[3] /= length;
+        }
+    }
+}
+
+size_t frustum_cull_spheres_scalar(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible)
+{
+    size_t visible_count = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int is_inside = 1;
+        for (int j = 0; j < FRUSTUM_PLANE_COUNT; ++j)
+        {
+            const float* const plane = frustum->planes[j];
+            const float distance = plane[0] * x[i] + plane[1] * y[i] + plane[2] * z[i] + plane[3];
+            is_inside &= distance >= -radius[i];
+        }
+
+        // Always store and only advance on a hit; the write stays within the first i + 1 entries
+        visible[visible_count] = (uint32_t)i;
+        visible_count += is_inside;
+    }
+    return visible_count;
+}
+
+#if CPU_FEATURES_SSE2
+
+size_t frustum_cull_spheres_sse(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible)
+{
+    __m128 planes[FRUSTUM_PLANE_COUNT][4];
+    for (int j = 0; j < FRUSTUM_PLANE_COUNT; ++j)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            planes[j][k] = _mm_set1_ps(frustum->planes[j][k]);
+        }
+    }
+
+    size_t visible_count = 0;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 sx = _mm_loadu_ps(x + i);
+        const __m128 sy = _mm_loadu_ps(y + i);
+        const __m128 sz = _mm_loadu_ps(z + i);
+        const __m128 negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+        __m128 is_inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int j = 0; j < FRUSTUM_PLANE_COUNT; ++j)
+        {
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planes[j][0], sx), _mm_mul_ps(planes[j][1], sy)),
+                _mm_add_ps(_mm_mul_ps(planes[j][2], sz), planes[j][3]));
+            is_inside = _mm_and_ps(is_inside, _mm_cmpge_ps(distance, negative_radius));
+        }
+
+        const int mask = _mm_movemask_ps(is_inside);
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            visible[visible_count] = (uint32_t)(i + lane);
+            visible_count += (mask >> lane) & 1;
+        }
+    }
+
+    // The tail's indices are offset by i, so they are shifted back into place
+    const size_t tail_count = frustum_cull_spheres_scalar(frustum, x + i, y + i, z + i, radius + i, count - i,
+        visible + visible_count);
+    for (size_t j = 0; j < tail_count; ++j)
+    {
+        visible[visible_count + j] += (uint32_t)i;
+    }
+
+    return visible_count + tail_count;
+}
+
+CPU_TARGET_AVX2 size_t frustum_cull_spheres_avx2(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible)
+{
+    __m256 planes[FRUSTUM_PLANE_COUNT][4];
+    for (int j = 0; j < FRUSTUM_PLANE_COUNT; ++j)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            planes[j][k] = _mm256_set1_ps(frustum->planes[j][k]);
+        }
+    }
+
+    size_t visible_count = 0;
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 sx = _mm256_loadu_ps(x + i);
+        const __m256 sy = _mm256_loadu_ps(y + i);
+        const __m256 sz = _mm256_loadu_ps(z + i);
+        const __m256 negative_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+
+        __m256 is_inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int j = 0; j < FRUSTUM_PLANE_COUNT; ++j)
+        {
+            const __m256 distance = _mm256_fmadd_ps(planes[j][0], sx,
+                _mm256_fmadd_ps(planes[j][1], sy, _mm256_fmadd_ps(planes[j][2], sz, planes[j][3])));
+            is_inside = _mm256_and_ps(is_inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(is_inside);
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            visible[visible_count] = (uint32_t)(i + lane);
+            visible_count += (mask >> lane) & 1;
+        }
+    }
+
+    const size_t tail_count = frustum_cull_spheres_sse(frustum, x + i, y + i, z + i, radius + i, count - i,
+        visible + visible_count);
+    for (size_t j = 0; j < tail_count; ++j)
+    {
+        visible[visible_count + j] += (uint32_t)i;
+    }
+
+    return visible_count + tail_count;
+}
+
+#endif
+
+static void frustum_select_kernels(void)
+{
+    frustum_cull_spheres_kernel = frustum_cull_spheres_scalar;
+    frustum_cull_spheres_kernel_name_value = "scalar";
+
+#if CPU_FEATURES_SSE2
+    frustum_cull_spheres_kernel = frustum_cull_spheres_sse;
+    frustum_cull_spheres_kernel_name_value = "sse";
+
+    const CpuFeatures* const features = cpu_features_get();
+    if (features->avx2 && features->fma)
+    {
+        frustum_cull_spheres_kernel = frustum_cull_spheres_avx2;
+        frustum_cull_spheres_kernel_name_value = "avx2";
+    }
+#endif
+}
+
+static size_t frustum_cull_spheres_resolve(const Frustum* const frustum,
+    const float* const x, const float* const y, const float* const z, const float* const radius,
+    const size_t count, uint32_t* const visible)
+{
+    frustum_select_kernels();
+
+    return frustum_cull_spheres_kernel(frustum, x, y, z, radius, count, visible);
+}
@@ -0,0 +1,128 @@
+#include "test_matrix/gl_ring_buffer.h"
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define GL_RING_BUFFER_WAIT_TIMEOUT_NS 1000000000ull
+
+static GLsizeiptr align_up(const GLsizeiptr value, const GLint alignment);
+
+bool gl_ring_buffer_create(GlRingBuffer* const ring, const GLsizeiptr region_size)
+{
+    memset(ring, 0, sizeof(*ring));
+
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ring->alignment);
+    if (ring->alignment < 16)
+    {
+        ring->alignment = 16;
+    }
+
+    ring->region_size = align_up(region_size, ring->alignment);
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr buffer_size = ring->region_size * GL_RING_BUFFER_REGION_COUNT;
+
+    glGenBuffers(1, &ring->buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, buffer_size, NULL, flags);
+
+    ring->mapping = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, buffer_size, flags);
+    if (ring->mapping == NULL)
+    {
+        fputs("Failed to map ring buffer\n", stderr);
+        return false;
+    }
+
+    // begin_frame advances first, so the first frame lands in region 0
+    ring->region = GL_RING_BUFFER_REGION_COUNT - 1;
+
+    return true;
+}
+
+void gl_ring_buffer_destroy(GlRingBuffer* const ring)
+{
+    for (int i = 0; i < GL_RING_BUFFER_REGION_COUNT; ++i)
+    {
+        if (ring->fences[i] != NULL)
+        {
+            glDeleteSync(ring->fences[i]);
+        }
+    }
+
+    if (ring->buffer != 0)
+    {
+        if (ring->mapping != NULL)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, ring->buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+
+        glDeleteBuffers(1, &ring->buffer);
+    }
+
+    memset(ring, 0, sizeof(*ring));
+}
+
+bool gl_ring_buffer_begin_frame(GlRingBuffer* const ring)
+{
+    ring->region = (ring->region + 1) % GL_RING_BUFFER_REGION_COUNT;
+    ring->region_offset = 0;
+
+    GLsync* const fence = &ring->fences[ring->region];
+    if (*fence == NULL)
+    {
+        return true;
+    }
+
+    // Flush on the first wait only; the commands are submitted after that
+    GLbitfield wait_flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;)
+    {
+        const GLenum status = glClientWaitSync(*fence, wait_flags, GL_RING_BUFFER_WAIT_TIMEOUT_NS);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+
+        if (status == GL_WAIT_FAILED)
+        {
+            fputs("Failed to wait for ring buffer fence\n", stderr);
+            return false;
+        }
+
+        wait_flags = 0;
+    }
+
+    glDeleteSync(*fence);
+    *fence = NULL;
+
+    return true;
+}
+
+void* gl_ring_buffer_allocate(GlRingBuffer* const ring, const GLsizeiptr size, GLintptr* const offset)
+{
+    const GLsizeiptr aligned_size = align_up(size, ring->alignment);
+    if (ring->region_offset + aligned_size > ring->region_size)
+    {
+        fputs("Ring buffer region is full\n", stderr);
+        return NULL;
+    }
+
+    *offset = (GLintptr)ring->region * ring->region_size + ring->region_offset;
+    ring->region_offset += aligned_size;
+
+    return ring->mapping + *offset;
+}
+
+void gl_ring_buffer_end_frame(GlRingBuffer* const ring)
+{
+    ring->fences[ring->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static GLsizeiptr align_up(const GLsizeiptr value, const GLint alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
@@ -0,0 +1,302 @@
+#include "test_matrix/glyph_atlas.h"
+
+#include <SDL_error.h>
+#include <SDL_pixels.h>
+#include <SDL_rect.h>
+#include <SDL_render.h>
+#include <SDL_surface.h>
+#include <SDL_ttf.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLYPH_ATLAS_WIDTH 512
+#define GLYPH_ATLAS_PADDING 1
+
+static bool text_geometry_reserve(TextGeometry* const geometry, const int vertex_count, const int index_count);
+
+bool glyph_atlas_create(GlyphAtlas* const atlas, SDL_Renderer* const renderer, TTF_Font* const font)
+{
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->line_skip = TTF_FontLineSkip(font);
+
+    const SDL_Color color_white = {255, 255, 255, 255};
+
+    SDL_Surface* glyph_surfaces[GLYPH_ATLAS_CHAR_COUNT] = {NULL};
+    SDL_Rect glyph_rects[GLYPH_ATLAS_CHAR_COUNT];
+
+    bool success = false;
+    SDL_Surface* atlas_surface = NULL;
+
+    int pen_x = 0;
+    int pen_y = 0;
+    int row_height = 0;
+
+    for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; ++i)
+    {
+        const Uint16 ch = (Uint16)(GLYPH_ATLAS_FIRST_CHAR + i);
+
+        int advance = 0;
+        if (TTF_GlyphMetrics(font, ch, NULL, NULL, NULL, NULL, &advance) < 0)
+        {
+            continue;
+        }
+        atlas->glyphs[i].advance = advance;
+
+        glyph_surfaces[i] = TTF_RenderGlyph_Blended(font, ch, color_white);
+        if (glyph_surfaces[i] == NULL)
+        {
+            fprintf(stderr, "Failed to render glyph '%c'\n", (char)ch);
+            fprintf(stderr, "TTF error: %s\n", TTF_GetError());
+            goto cleanup;
+        }
+
+        const int w = glyph_surfaces[i]->w;
+        const int h = glyph_surfaces[i]->h;
+
+        if (pen_x + w > GLYPH_ATLAS_WIDTH)
+        {
+            pen_x = 0;
+            pen_y += row_height + GLYPH_ATLAS_PADDING;
+            row_height = 0;
+        }
+
+        glyph_rects[i] = (SDL_Rect){pen_x, pen_y, w, h};
+
+        pen_x += w + GLYPH_ATLAS_PADDING;
+        if (h > row_height)
+        {
+            row_height = h;
+        }
+    }
+
+    const int atlas_height = pen_y + row_height;
+
+    atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_ATLAS_WIDTH, atlas_height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (atlas_surface == NULL)
+    {
+        fputs("Failed to create glyph atlas surface\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+        goto cleanup;
+    }
+
+    SDL_FillRect(atlas_surface, NULL, 0);
+
+    for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; ++i)
+    {
+        if (glyph_surfaces[i] == NULL)
+        {
+            continue;
+        }
+
+        // Copy the glyph's coverage as is instead of blending it onto the transparent atlas
+        SDL_SetSurfaceBlendMode(glyph_surfaces[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(glyph_surfaces[i], NULL, atlas_surface, &glyph_rects[i]);
+
+        Glyph* const glyph = &atlas->glyphs[i];
+        glyph->width = glyph_rects[i].w;
+        glyph->height = glyph_rects[i].h;
+        glyph->uv_min.x = (float)glyph_rects[i].x / GLYPH_ATLAS_WIDTH;
+        glyph->uv_min.y = (float)glyph_rects[i].y / atlas_height;
+        glyph->uv_max.x = (float)(glyph_rects[i].x + glyph_rects[i].w) / GLYPH_ATLAS_WIDTH;
+        glyph->uv_max.y = (float)(glyph_rects[i].y + glyph_rects[i].h) / atlas_height;
+    }
+
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, atlas_surface);
+    if (atlas->texture == NULL)
+    {
+        fputs("Failed to create glyph atlas texture\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+        goto cleanup;
+    }
+
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+
+    success = true;
+
+cleanup:
+    if (atlas_surface != NULL)
+    {
+        SDL_FreeSurface(atlas_surface);
+    }
+
+    for (int i = 0; i < GLYPH_ATLAS_CHAR_COUNT; ++i)
+    {
+        if (glyph_surfaces[i] != NULL)
+        {
+            SDL_FreeSurface(glyph_surfaces[i]);
+        }
+    }
+
+    return success;
+}
+
+void glyph_atlas_destroy(GlyphAtlas* const atlas)
+{
+    if (atlas->texture != NULL)
+    {
+        SDL_DestroyTexture(atlas->texture);
+        atlas->texture = NULL;
+    }
+}
+
+bool glyph_atlas_append_text(const GlyphAtlas* const atlas, TextGeometry* const geometry,
+    const char* const text, const SDL_Color color, const int x, const int y)
+{
+    const int text_length = (int)strlen(text);
+    if (!text_geometry_reserve(geometry, 4 * text_length, 6 * text_length))
+    {
+        return false;
+    }
+
+    float pen_x = (float)x;
+    float pen_y = (float)y;
+
+    for (const char* ch = text; *ch != '\0'; ++ch)
+    {
+        if (*ch == '\n')
+        {
+            pen_x = (float)x;
+            pen_y += (float)atlas->line_skip;
+            continue;
+        }
+
+        const char glyph_char = (*ch >= GLYPH_ATLAS_FIRST_CHAR && *ch <= GLYPH_ATLAS_LAST_CHAR) ? *ch : '?';
+        const Glyph* const glyph = &atlas->glyphs[glyph_char - GLYPH_ATLAS_FIRST_CHAR];
+
+        if (glyph->width > 0 && glyph->height > 0)
+        {
+            const float x0 = pen_x;
+            const float y0 = pen_y;
+            const float x1 = pen_x + (float)glyph->width;
+            const float y1 = pen_y + (float)glyph->height;
+
+            const int first_vertex = geometry->vertex_count;
+            SDL_Vertex* const vertices = &geometry->vertices[first_vertex];
+            vertices[0] = (SDL_Vertex){{x0, y0}, color, {glyph->uv_min.x, glyph->uv_min.y}};
+            vertices[1] = (SDL_Vertex){{x1, y0}, color, {glyph->uv_max.x, glyph->uv_min.y}};
+            vertices[2] = (SDL_Vertex){{x1, y1}, color, {glyph->uv_max.x, glyph->uv_max.y}};
+            vertices[3] = (SDL_Vertex){{x0, y1}, color, {glyph->uv_min.x, glyph->uv_max.y}};
+            geometry->vertex_count += 4;
+
+            int* const indices = &geometry->indices[geometry->index_count];
+            indices[0] = first_vertex;
+            indices[1] = first_vertex + 1;
+            indices[2] = first_vertex + 2;
+            indices[3] = first_vertex;
+            indices[4] = first_vertex + 2;
+            indices[5] = first_vertex + 3;
+            geometry->index_count += 6;
+        }
+
+        pen_x += (float)glyph->advance;
+    }
+
+    return true;
+}
+
+bool glyph_atlas_draw(const GlyphAtlas* const atlas, SDL_Renderer* const renderer,
+    const TextGeometry* const geometry)
+{
+    if (geometry->index_count == 0)
+    {
+        return true;
+    }
+
+    if (SDL_RenderGeometry(renderer, atlas->texture, geometry->vertices, geometry->vertex_count,
+        geometry->indices, geometry->index_count) < 0)
+    {
+        fputs("Failed to render text geometry\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+bool text_geometry_append(TextGeometry* const geometry, const TextGeometry* const other)
+{
+    if (other->vertex_count == 0)
+    {
+        return true;
+    }
+
+    if (!text_geometry_reserve(geometry, other->vertex_count, other->index_count))
+    {
+        return false;
+    }
+
+    const int first_vertex = geometry->vertex_count;
+
+    memcpy(&geometry->vertices[first_vertex], other->vertices, other->vertex_count * sizeof(SDL_Vertex));
+    geometry->vertex_count += other->vertex_count;
+
+    int* const indices = &geometry->indices[geometry->index_count];
+    for (int i = 0; i < other->index_count; ++i)
+    {
+        indices[i] = first_vertex + other->indices[i];
+    }
+    geometry->index_count += other->index_count;
+
+    return true;
+}
+
+void text_geometry_clear(TextGeometry* const geometry)
+{
+    geometry->vertex_count = 0;
+    geometry->index_count = 0;
+}
+
+void text_geometry_destroy(TextGeometry* const geometry)
+{
+    free(geometry->indices);
+    free(geometry->vertices);
+    memset(geometry, 0, sizeof(*geometry));
+}
+
+static bool text_geometry_reserve(TextGeometry* const geometry, const int vertex_count, const int index_count)
+{
+    const int required_vertex_capacity = geometry->vertex_count + vertex_count;
+    if (required_vertex_capacity > geometry->vertex_capacity)
+    {
+        int new_capacity = geometry->vertex_capacity > 0 ? geometry->vertex_capacity : 256;
+        while (new_capacity < required_vertex_capacity)
+        {
+            new_capacity *= 2;
+        }
+
+        SDL_Vertex* const new_vertices = realloc(geometry->vertices, new_capacity * sizeof(SDL_Vertex));
+        if (new_vertices == NULL)
+        {
+            fputs("Failed to allocate memory for text vertices\n", stderr);
+            return false;
+        }
+
+        geometry->vertices = new_vertices;
+        geometry->vertex_capacity = new_capacity;
+    }
+
+    const int required_index_capacity = geometry->index_count + index_count;
+    if (required_index_capacity > geometry->index_capacity)
+    {
+        int new_capacity = geometry->index_capacity > 0 ? geometry->index_capacity : 384;
+        while (new_capacity < required_index_capacity)
+        {
+            new_capacity *= 2;
+        }
+
+        int* const new_indices = realloc(geometry->indices, new_capacity * sizeof(int));
+        if (new_indices == NULL)
+        {
+            fputs("Failed to allocate memory for text indices\n", stderr);
+            return false;
+        }
+
+        geometry->indices = new_indices;
+        geometry->index_capacity = new_capacity;
+    }
+
+    return true;
+}
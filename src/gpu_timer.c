@@ -0,0 +1,86 @@
+#include "test_matrix/gpu_timer.h"
+
+#include "glad/glad.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+static bool gpu_timer_collect(GpuTimer* const timer, const int query);
+
+void gpu_timer_create(GpuTimer* const timer)
+{
+    memset(timer, 0, sizeof(*timer));
+    glGenQueries(GPU_TIMER_QUERY_COUNT, timer->queries);
+}
+
+void gpu_timer_destroy(GpuTimer* const timer)
+{
+    if (timer->queries[0] != 0)
+    {
+        glDeleteQueries(GPU_TIMER_QUERY_COUNT, timer->queries);
+    }
+
+    memset(timer, 0, sizeof(*timer));
+}
+
+void gpu_timer_begin(GpuTimer* const timer)
+{
+    const int query = timer->next_query;
+    if (timer->is_query_pending[query] && !gpu_timer_collect(timer, query))
+    {
+        timer->is_query_active = false;
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, timer->queries[query]);
+    timer->is_query_active = true;
+}
+
+void gpu_timer_end(GpuTimer* const timer)
+{
+    if (!timer->is_query_active)
+    {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    timer->is_query_active = false;
+
+    timer->is_query_pending[timer->next_query] = true;
+    timer->next_query = (timer->next_query + 1) % GPU_TIMER_QUERY_COUNT;
+}
+
+bool gpu_timer_poll(GpuTimer* const timer)
+{
+    bool is_updated = false;
+
+    // Oldest first, so last_gpu_ms ends up holding the most recent finished frame
+    for (int i = 0; i < GPU_TIMER_QUERY_COUNT; ++i)
+    {
+        const int query = (timer->next_query + i) % GPU_TIMER_QUERY_COUNT;
+        if (timer->is_query_pending[query] && gpu_timer_collect(timer, query))
+        {
+            is_updated = true;
+        }
+    }
+
+    return is_updated;
+}
+
+static bool gpu_timer_collect(GpuTimer* const timer, const int query)
+{
+    GLint is_available = GL_FALSE;
+    glGetQueryObjectiv(timer->queries[query], GL_QUERY_RESULT_AVAILABLE, &is_available);
+    if (!is_available)
+    {
+        return false;
+    }
+
+    GLuint64 elapsed_ns = 0;
+    glGetQueryObjectui64v(timer->queries[query], GL_QUERY_RESULT, &elapsed_ns);
+
+    timer->is_query_pending[query] = false;
+    timer->last_gpu_ms = (double)elapsed_ns / 1e6;
+
+    return true;
+}
@@ -0,0 +1,226 @@
+#include "test_matrix/headless.h"
+
+#include "glad/glad.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static bool has_extension(const char* const extensions, const char* const name);
+
+static EGLDisplay get_display(void);
+
+bool headless_context_create(HeadlessContext* const headless, const int width, const int height)
+{
+    memset(headless, 0, sizeof(*headless));
+    headless->display = EGL_NO_DISPLAY;
+    headless->context = EGL_NO_CONTEXT;
+    headless->surface = EGL_NO_SURFACE;
+    headless->width = width;
+    headless->height = height;
+
+    headless->display = get_display();
+    if (headless->display == EGL_NO_DISPLAY)
+    {
+        fputs("Failed to get EGL display\n", stderr);
+        return false;
+    }
+
+    if (!eglInitialize(headless->display, NULL, NULL))
+    {
+        fputs("Failed to initialize EGL\n", stderr);
+        fprintf(stderr, "EGL error: 0x%x\n", eglGetError());
+        headless->display = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        fputs("Failed to bind OpenGL API\n", stderr);
+        fprintf(stderr, "EGL error: 0x%x\n", eglGetError());
+        return false;
+    }
+
+    const char* const extensions = eglQueryString(headless->display, EGL_EXTENSIONS);
+    const bool is_surfaceless = has_extension(extensions, "EGL_KHR_surfaceless_context");
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, is_surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config = NULL;
+    EGLint config_count = 0;
+    eglChooseConfig(headless->display, config_attributes, &config, 1, &config_count);
+    if (config_count == 0)
+    {
+        if (!is_surfaceless || !has_extension(extensions, "EGL_KHR_no_config_context"))
+        {
+            fputs("Failed to choose EGL config\n", stderr);
+            return false;
+        }
+
+        // Everything is drawn into our own framebuffer, so the context needs no config
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    // llvmpipe and other software drivers may stop at 4.5, which the shaders are written against
+    const EGLint minor_versions[] = {6, 5};
+    for (size_t i = 0; i < sizeof(minor_versions) / sizeof(minor_versions[0]); ++i)
+    {
+        const EGLint context_attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, minor_versions[i],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+
+        headless->context = eglCreateContext(headless->display, config, EGL_NO_CONTEXT, context_attributes);
+        if (headless->context != EGL_NO_CONTEXT)
+        {
+            break;
+        }
+    }
+
+    if (headless->context == EGL_NO_CONTEXT)
+    {
+        fputs("Failed to create OpenGL context\n", stderr);
+        fprintf(stderr, "EGL error: 0x%x\n", eglGetError());
+        return false;
+    }
+
+    if (!is_surfaceless)
+    {
+        const EGLint surface_attributes[] = {
+            EGL_WIDTH, width,
+            EGL_HEIGHT, height,
+            EGL_NONE
+        };
+
+        headless->surface = eglCreatePbufferSurface(headless->display, config, surface_attributes);
+        if (headless->surface == EGL_NO_SURFACE)
+        {
+            fputs("Failed to create pbuffer surface\n", stderr);
+            fprintf(stderr, "EGL error: 0x%x\n", eglGetError());
+            return false;
+        }
+    }
+
+    if (!eglMakeCurrent(headless->display, headless->surface, headless->surface, headless->context))
+    {
+        fputs("Failed to make OpenGL context current\n", stderr);
+        fprintf(stderr, "EGL error: 0x%x\n", eglGetError());
+        return false;
+    }
+
+    if (!gladLoadGLLoader(headless_get_proc_address))
+    {
+        fputs("Failed to initialize glad\n", stderr);
+        return false;
+    }
+
+    glGenRenderbuffers(1, &headless->color_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, headless->color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenFramebuffers(1, &headless->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless->color_renderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fputs("Failed to create headless framebuffer\n", stderr);
+        return false;
+    }
+
+    glViewport(0, 0, width, height);
+
+    return true;
+}
+
+void headless_context_destroy(HeadlessContext* const headless)
+{
+    if (headless->context != EGL_NO_CONTEXT)
+    {
+        if (headless->framebuffer != 0)
+        {
+            glDeleteFramebuffers(1, &headless->framebuffer);
+        }
+
+        if (headless->color_renderbuffer != 0)
+        {
+            glDeleteRenderbuffers(1, &headless->color_renderbuffer);
+        }
+
+        eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(headless->display, headless->context);
+    }
+
+    if (headless->surface != EGL_NO_SURFACE)
+    {
+        eglDestroySurface(headless->display, headless->surface);
+    }
+
+    if (headless->display != EGL_NO_DISPLAY)
+    {
+        eglTerminate(headless->display);
+    }
+
+    memset(headless, 0, sizeof(*headless));
+}
+
+static bool has_extension(const char* const extensions, const char* const name)
+{
+    if (extensions == NULL)
+    {
+        return false;
+    }
+
+    const size_t name_length = strlen(name);
+    for (const char* match = strstr(extensions, name); match != NULL; match = strstr(match + name_length, name))
+    {
+        const bool is_start_ok = match == extensions || match[-1] == ' ';
+        const bool is_end_ok = match[name_length] == ' ' || match[name_length] == '\0';
+        if (is_start_ok && is_end_ok)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void* headless_get_proc_address(const char* const name)
+{
+    // glad wants an object pointer, which ISO C does not allow casting a function pointer to
+    void (*const proc)(void) = eglGetProcAddress(name);
+
+    void* address;
+    memcpy(&address, &proc, sizeof(address));
+    return address;
+}
+
+static EGLDisplay get_display(void)
+{
+    // Prefer Mesa's surfaceless platform, which needs neither a GPU nor a display server
+    const char* const client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (has_extension(client_extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC const get_platform_display =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (get_platform_display != NULL)
+        {
+            const EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if (display != EGL_NO_DISPLAY)
+            {
+                return display;
+            }
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
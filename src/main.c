@@ -1,4 +1,25 @@
 #include "glad/glad.h"
+#include "test_matrix/camera_block.h"
+#ifdef TEST_MATRIX_EMBED_RESOURCES
+#include "test_matrix/embedded_resources.h"
+#endif
+#include "test_matrix/frame_profiler.h"
+#include "test_matrix/frustum.h"
+#include "test_matrix/gl_ring_buffer.h"
+#include "test_matrix/glyph_atlas.h"
+#include "test_matrix/gpu_timer.h"
+#ifdef TEST_MATRIX_HEADLESS
+#include "test_matrix/headless.h"
+#endif
+#include "test_matrix/mat4f.h"
+#include "test_matrix/mesh_file.h"
+#include "test_matrix/program_build.h"
+#include "test_matrix/program_cache.h"
+#include "test_matrix/resource_pack.h"
+#include "test_matrix/scene.h"
+#include "test_matrix/shader_watcher.h"
+#include "test_matrix/text_line.h"
+#include "test_matrix/vec3f.h"
 
 #include <SDL.h>
 #include <SDL_error.h>
@@ -11,92 +32,279 @@
 #include <SDL_pixels.h>
 #include <SDL_rect.h>
 #include <SDL_render.h>
+#include <SDL_rwops.h>
 #include <SDL_stdinc.h>
 #include <SDL_surface.h>
+#include <SDL_timer.h>
 #include <SDL_ttf.h>
 #include <SDL_video.h>
 
+#include <assert.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct Vec3f
-{
-    float value[3];
-} Vec3f;
+#define HEADLESS_WIDTH 900
+#define HEADLESS_HEIGHT 900
 
-static float vec3f_get_length(const Vec3f* const vec);
+// Percentiles are recomputed every this many frames rather than every frame
+#define FRAME_STATS_INTERVAL 30
 
-static Vec3f vec3f_normalize(const Vec3f* const vec);
+// How long on-demand mode sleeps without events before checking for late GPU timer results
+#define ON_DEMAND_TIMEOUT_MS 250
 
-static Vec3f vec3f_cross(const Vec3f* const vec1, const Vec3f* const vec2);
+#define MESH_PATH_CAPACITY 16
 
-typedef struct Mat4f
-{
-    float value[4][4];
-} Mat4f;
+#define CAMERA_FOV_Y_DEG 60.0f
+#define CAMERA_NEAR_Z 0.1f
+
+bool is_headless = false;
+int headless_frame_count = 300;
+
+const char* profile_output_path = NULL;
+
+int instance_count = 1;
+
+bool is_on_demand = false;
 
-static Mat4f mat4f_product(const Mat4f* const mat1, const Mat4f* const mat2);
+bool is_gpu_culling = false;
+
+// Meshes from --mesh, or the default meshes when none are given
+const char* mesh_paths[MESH_PATH_CAPACITY] = {0};
+int mesh_path_count = 0;
+
+const char* const default_mesh_names[] = {
+    "meshes/cube.mesh",
+    "meshes/pyramid.mesh"
+};
+
+#ifdef TEST_MATRIX_HEADLESS
+HeadlessContext headless_context = {0};
+#endif
 
 char* absolute_bin_dir = NULL;
-char* absolute_font_path = NULL;
+
+// Everything under resources/, built into one file that stays mapped for the whole run
+ResourcePack resource_pack = {0};
+
 TTF_Font* font = NULL;
 
 SDL_Window* main_window = NULL;
 SDL_GLContext gl_context = NULL;
 
-GLuint vertex_shader = 0;
-GLuint fragment_shader = 0;
+ProgramCache program_cache = {0};
+
 GLuint shader_program = 0;
+GLuint cull_program = 0;
+
+// Programs compiling in the background; they replace the ones above together once all of them are done
+ProgramBuild scene_program_build = {0};
+ProgramBuild cull_program_build = {0};
+bool are_programs_building = false;
 
-GLuint vbo = 0;
-GLuint ebo = 0;
-GLuint vao = 0;
+ShaderWatcher shader_watcher = {.fd = -1};
+
+// The scene renders into its own framebuffer for the float depth buffer, then gets blitted to the
+// window's, or the headless context's, framebuffer
+GLuint scene_framebuffer = 0;
+GLuint scene_color_renderbuffer = 0;
+GLuint scene_depth_renderbuffer = 0;
+int scene_width = 0;
+int scene_height = 0;
+
+GLuint present_framebuffer = 0;
+
+const SceneVertex vertices[] = {
+    // position            color
+    {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+    {{-0.5f,  0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+    {{ 0.5f,  0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+    {{ 0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 1.0f}}
+};
+
+const GLuint indices[] = {
+    0, 1, 2,
+    0, 2, 3
+};
+
+// Mesh files hand their mapped data to the scene, so they stay open until it is uploaded
+static_assert(sizeof(MeshFileVertex) == sizeof(SceneVertex)
+    && offsetof(MeshFileVertex, color) == offsetof(SceneVertex, color),
+    "Mesh files must store vertices the way the scene uploads them");
+
+MeshFile mesh_files[MESH_PATH_CAPACITY] = {0};
+int mesh_file_count = 0;
+
+Scene scene = {0};
+GlRingBuffer ring_buffer = {0};
+
+int visible_object_count = 0;
+
+GpuTimer gpu_timer = {0};
+
+FrameProfiler frame_profiler;
 
 SDL_Window* info_window = NULL;
 SDL_Renderer* renderer = NULL;
 
+GlyphAtlas glyph_atlas = {0};
+TextGeometry text_geometry = {0};
+
+typedef enum InfoLine
+{
+    INFO_LINE_POINTS_0,
+    INFO_LINE_POINTS_1,
+    INFO_LINE_POINTS_2,
+    INFO_LINE_POINTS_3,
+    INFO_LINE_WORLD_UP,
+    INFO_LINE_YAW_DEG,
+    INFO_LINE_PITCH_DEG,
+    INFO_LINE_CAMERA_POS,
+    INFO_LINE_CAMERA_DIR,
+    INFO_LINE_CAMERA_RIGHT,
+    INFO_LINE_CAMERA_UP,
+    INFO_LINE_LOOK_AT,
+    INFO_LINE_MOTION_EVENTS,
+    INFO_LINE_COALESCED_EVENTS,
+    INFO_LINE_CPU_MS,
+    INFO_LINE_GPU_MS,
+    INFO_LINE_EVENTS_STATS,
+    INFO_LINE_SUBMIT_STATS,
+    INFO_LINE_SWAP_STATS,
+    INFO_LINE_INFO_STATS,
+    INFO_LINE_FRAME_STATS,
+    INFO_LINE_FRAME_HISTOGRAM,
+    INFO_LINE_VISIBLE_OBJECTS,
+    INFO_LINE_CULLED_OBJECTS,
+    INFO_LINE_COUNT
+} InfoLine;
+
+TextLine info_lines[INFO_LINE_COUNT] = {0};
+
+static bool create_main_window(void);
+
+static bool create_headless_context(void);
+
+static bool begin_program_builds(const bool is_from_disk);
+
+static ProgramBuildStatus poll_program_builds(void);
+
+static void cancel_program_builds(void);
+
+static bool create_scene(void);
+
+static bool create_scene_framebuffer(const int width, const int height);
+
+static bool create_info_window(void);
+
+static void draw_scene(const CameraBlock* const camera);
+
+static void draw_objects(const CameraBlock* const camera);
+
+static bool run_headless(const CameraBlock* const camera);
+
 static void cleanup(void);
 
 static char* get_absolute_path(const char* const relative_path);
 
-static GLuint load_shader(const char* const relative_path, const GLenum type);
+static bool find_resource(const char* const name, Resource* const resource);
+
+static char* read_text_file(const char* const path);
+
+static char* read_resource_source(const char* const name);
+
+static bool begin_program_build(ProgramBuild* const build, const char* const* const names,
+    const GLenum* const types, const int shader_count, const bool is_from_disk);
 
-static bool render_text(const char* const text, const SDL_Color color, const int x, const int y);
+static bool render_text(TextLine* const line, const TextLineKey* const key, const char* const text);
+
+static bool render_text_float(const InfoLine line, const char* const name, const float value,
+    const SDL_Color color, const int x, const int y);
+
+static bool render_text_vec3f(const InfoLine line, const char* const name, const Vec3f* const vec,
+    const SDL_Color color, const int x, const int y);
 
-static bool render_text_float(const char* const name, const float value,
+static bool render_text_mat4f(const InfoLine line, const char* const name, const Mat4f* const mat,
     const SDL_Color color, const int x, const int y);
 
-static bool render_text_vec3f(const char* const name, const Vec3f* const vec,
+static bool render_text_stats(const InfoLine line, const char* const name, const FrameStats* const stats,
     const SDL_Color color, const int x, const int y);
 
-static bool render_text_mat4f(const char* const name, const Mat4f* const mat,
+static bool render_text_histogram(const InfoLine line, const char* const name, const FrameStats* const stats,
     const SDL_Color color, const int x, const int y);
 
+// The histogram's buckets are the values of its text line's key
+static_assert(FRAME_HISTOGRAM_BUCKET_COUNT <= TEXT_LINE_MAX_VALUES,
+    "Frame histogram buckets must fit in a text line key");
+
 int main(int argc, char* argv[])
 {
-    (void)argc;
-    (void)argv;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            is_headless = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            headless_frame_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--profile-output") == 0 && i + 1 < argc)
+        {
+            profile_output_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+        {
+            instance_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--on-demand") == 0)
+        {
+            is_on_demand = true;
+        }
+        else if (strcmp(argv[i], "--gpu-cull") == 0)
+        {
+            is_gpu_culling = true;
+        }
+        else if (strcmp(argv[i], "--mesh") == 0 && i + 1 < argc && mesh_path_count < MESH_PATH_CAPACITY)
+        {
+            mesh_paths[mesh_path_count++] = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--headless [--frames N]] [--instances N] [--on-demand] "
+                "[--gpu-cull] [--mesh PATH]... [--profile-output PATH]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (instance_count <= 0)
+    {
+        fputs("Instance count must be positive\n", stderr);
+        return EXIT_FAILURE;
+    }
 
     atexit(cleanup);
 
-    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS) < 0)
+    const Uint32 sdl_flags = is_headless ? SDL_INIT_TIMER : SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_EVENTS;
+    if (SDL_Init(sdl_flags) < 0)
     {
         fputs("Failed to initialize SDL\n", stderr);
         fprintf(stderr, "SDL error: %s\n", SDL_GetError());
         return EXIT_FAILURE;
     }
 
-    if (TTF_Init() < 0)
+#ifdef TEST_MATRIX_EMBED_RESOURCES
+    // Nothing is loaded from next to the executable, so there's no need to know where it is
+    if (!resource_pack_open_memory(&resource_pack, embedded_resource_pack, embedded_resource_pack_size,
+        "embedded resources"))
     {
-        fputs("Failed to initialize SDL_ttf\n", stderr);
-        fprintf(stderr, "TTF error: %s\n", TTF_GetError());
         return EXIT_FAILURE;
     }
-
+#else
     absolute_bin_dir = SDL_GetBasePath();
     if (absolute_bin_dir == NULL)
     {
@@ -105,194 +313,147 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    absolute_font_path = get_absolute_path("resources/fonts/IosevkaNerdFont-Regular.ttf");
-    if (absolute_font_path == NULL)
+    char* const absolute_pack_path = get_absolute_path("resources.pack");
+    if (absolute_pack_path == NULL)
     {
         return EXIT_FAILURE;
     }
 
-    font = TTF_OpenFont(absolute_font_path, 24);
-    if (font == NULL)
+    const bool is_pack_open = resource_pack_open(&resource_pack, absolute_pack_path);
+    free(absolute_pack_path);
+    if (!is_pack_open)
     {
-        fprintf(stderr, "Failed to open font %s\n", absolute_font_path);
         return EXIT_FAILURE;
     }
-
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 6);
-
-#ifdef SDL_HINT_IME_SHOW_UI
-    SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
 #endif
 
-    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
-    SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
-
-    main_window = SDL_CreateWindow("Main", 20, 20, 900, 900, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
-    if (main_window == NULL)
+    if (is_headless)
     {
-        fputs("Failed to create main window\n", stderr);
-        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
-        return EXIT_FAILURE;
+        if (!create_headless_context())
+        {
+            return EXIT_FAILURE;
+        }
     }
-
-    gl_context = SDL_GL_CreateContext(main_window);
-    if (gl_context == NULL)
+    else
     {
-        fputs("Failed to create OpenGL context\n", stderr);
-        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
-        return EXIT_FAILURE;
+        if (!create_main_window())
+        {
+            return EXIT_FAILURE;
+        }
     }
 
-    if (!gladLoadGLLoader(SDL_GL_GetProcAddress))
+    if (!create_scene())
     {
-        fputs("Failed to initialize glad\n", stderr);
         return EXIT_FAILURE;
     }
 
-    vertex_shader = load_shader("resources/shaders/shader.vert", GL_VERTEX_SHADER);
-    if (vertex_shader == 0)
+    int drawable_width = HEADLESS_WIDTH;
+    int drawable_height = HEADLESS_HEIGHT;
+
+    if (is_headless)
     {
-        return EXIT_FAILURE;
+#ifdef TEST_MATRIX_HEADLESS
+        present_framebuffer = headless_context.framebuffer;
+#endif
+    }
+    else
+    {
+        SDL_GL_GetDrawableSize(main_window, &drawable_width, &drawable_height);
     }
 
-    fragment_shader = load_shader("resources/shaders/shader.frag", GL_FRAGMENT_SHADER);
-    if (fragment_shader == 0)
+    if (!create_scene_framebuffer(drawable_width, drawable_height))
     {
         return EXIT_FAILURE;
     }
 
-    shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertex_shader);
-    glAttachShader(shader_program, fragment_shader);
-    glLinkProgram(shader_program);
-    glDetachShader(shader_program, fragment_shader);
-    glDetachShader(shader_program, vertex_shader);
+    gpu_timer_create(&gpu_timer);
+    frame_profiler_init(&frame_profiler);
 
-    glDeleteShader(fragment_shader);
-    fragment_shader = 0;
+    const Vec3f world_up = {0.0f, 1.0f, 0.0f};
+
+    Vec3f camera_pos = {0.0f, 0.0f, 3.0f};
+    Vec3f camera_dir = {0.0f, 0.0f, -1.0f};
+    Vec3f camera_right = vec3f_cross(&camera_dir, &world_up);
+    camera_right = vec3f_normalize(&camera_right);
+    Vec3f camera_up = vec3f_cross(&camera_right, &camera_dir);
 
-    glDeleteShader(vertex_shader);
-    vertex_shader = 0;
+    float yaw_deg = 0.0f;
+    float pitch_deg = 0.0f;
 
-    GLint success;
-    glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        GLchar info_log[512];
-        glGetProgramInfoLog(shader_program, 512, NULL, info_log);
-        fputs("Failed to link shader program\n", stderr);
-        fprintf(stderr, "Info log: %s\n", info_log);
-        return EXIT_FAILURE;
-    }
+    float cpu_ms = 0.0f;
 
-    const float vertices[] = {
-        // position         color
-        -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
-        -0.5f,  0.5f, 0.0f, 0.0f, 1.0f, 0.0f,
-         0.5f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f,
-         0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 1.0f
-    };
+    Mat4f look_at_matrix = mat4f_look_at(&camera_right, &camera_up, &camera_dir, &camera_pos);
 
-    const unsigned int indices[] = {
-        0, 1, 2,
-        0, 2, 3
+    CameraBlock camera = {
+        .view = look_at_matrix,
+        .projection = mat4f_perspective_reverse_z_infinite(CAMERA_FOV_Y_DEG * M_PI / 180.0f,
+            (float)drawable_width / (float)drawable_height, CAMERA_NEAR_Z)
     };
 
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    if (is_headless)
+    {
+        if (!run_headless(&camera))
+        {
+            return EXIT_FAILURE;
+        }
 
-    glGenBuffers(1, &ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        if (profile_output_path != NULL && !frame_profiler_dump(&frame_profiler, profile_output_path))
+        {
+            return EXIT_FAILURE;
+        }
 
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+        return EXIT_SUCCESS;
+    }
 
-    info_window = SDL_CreateWindow("Info", 940, 20, 900, 900, SDL_WINDOW_RESIZABLE);
-    if (info_window == NULL)
+    if (!create_info_window())
     {
-        fputs("Failed to create info window\n", stderr);
-        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
         return EXIT_FAILURE;
     }
 
-    renderer = SDL_CreateRenderer(info_window, -1, SDL_RENDERER_ACCELERATED);
-    if (renderer == NULL)
+#ifndef TEST_MATRIX_EMBED_RESOURCES
+    // Hot reload is a convenience, so the app still runs without it, e.g. when the source tree is gone
+    if (!shader_watcher_create(&shader_watcher, TEST_MATRIX_RESOURCE_SOURCE_DIR "shaders"))
     {
-        fputs("Failed to create renderer\n", stderr);
-        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
-        return EXIT_FAILURE;
+        fputs("Shaders won't be reloaded on changes\n", stderr);
     }
+#endif
 
     const Vec3f points[] = {
-        {vertices[0], vertices[1], vertices[2]},
-        {vertices[6], vertices[7], vertices[8]},
-        {vertices[12], vertices[13], vertices[14]},
-        {vertices[18], vertices[19], vertices[20]},
+        {vertices[0].position[0], vertices[0].position[1], vertices[0].position[2]},
+        {vertices[1].position[0], vertices[1].position[1], vertices[1].position[2]},
+        {vertices[2].position[0], vertices[2].position[1], vertices[2].position[2]},
+        {vertices[3].position[0], vertices[3].position[1], vertices[3].position[2]},
     };
 
     const SDL_Color color_blue = {0, 128, 255, 255};
     const SDL_Color color_green = {128, 255, 0, 255};
     const SDL_Color color_orange = {255, 128, 0, 255};
 
-    const Vec3f world_up = {0.0f, 1.0f, 0.0f};
-
-    Vec3f camera_pos = {0.0f, 0.0f, 3.0f};
-    Vec3f camera_dir = {0.0f, 0.0f, -1.0f};
-    Vec3f camera_right = vec3f_cross(&camera_dir, &world_up);
-    camera_right = vec3f_normalize(&camera_right);
-    Vec3f camera_up = vec3f_cross(&camera_right, &camera_dir);
-
-    float yaw_deg = 0.0f;
-    float pitch_deg = 0.0f;
-
-    Mat4f look_at_matrix;
-
-    {
-        const float* const R = camera_right.value;
-        const float* const U = camera_up.value;
-        const float* const D = camera_dir.value;
-        const float* const P = camera_pos.value;
-
-        const Mat4f mat1 = {.value = {
-            {R[0], R[1], R[2], 0.0f},
-            {U[0], U[1], U[2], 0.0f},
-            {D[0], D[1], D[2], 0.0f},
-            {0.0f, 0.0f, 0.0f, 1.0f}
-        }};
-
-        const Mat4f mat2 = {.value = {
-            {1.0f, 0.0f, 0.0f, -P[0]},
-            {0.0f, 1.0f, 0.0f, -P[1]},
-            {0.0f, 0.0f, 1.0f, -P[2]},
-            {0.0f, 0.0f, 0.0f, 1.0f}
-        }};
+    bool is_lmb_pressed = false;
 
-        look_at_matrix = mat4f_product(&mat1, &mat2);
-    }
+    int motion_event_count = 0;
+    int last_motion_event_count = 0;
+    int coalesced_event_count = 0;
 
-    SDL_GL_MakeCurrent(main_window, gl_context);
-    glUseProgram(shader_program);
-    const GLint view_location = glGetUniformLocation(shader_program, "view");
+    FrameStats frame_stats[FRAME_SECTION_COUNT] = {0};
+    int frames_until_stats = 0;
 
-    bool is_lmb_pressed = false;
+    bool needs_redraw = true;
+    bool is_viewport_dirty = false;
 
     bool quit = false;
     while (!quit)
     {
         SDL_Event event;
-        while (SDL_PollEvent(&event))
+
+        // In on-demand mode, sleep until something happens instead of spinning
+        bool has_event = is_on_demand && !needs_redraw
+            ? SDL_WaitEventTimeout(&event, ON_DEMAND_TIMEOUT_MS)
+            : SDL_PollEvent(&event);
+
+        frame_profiler_begin_frame(&frame_profiler);
+
+        for (; has_event; has_event = SDL_PollEvent(&event))
         {
             switch (event.type)
             {
@@ -301,6 +462,29 @@ int main(int argc, char* argv[])
                     quit = true;
                     break;
                 }
+                case SDL_WINDOWEVENT:
+                {
+                    switch (event.window.event)
+                    {
+                        case SDL_WINDOWEVENT_SIZE_CHANGED:
+                        {
+                            if (event.window.windowID == SDL_GetWindowID(main_window))
+                            {
+                                is_viewport_dirty = true;
+                            }
+
+                            needs_redraw = true;
+                            break;
+                        }
+                        case SDL_WINDOWEVENT_EXPOSED:
+                        {
+                            needs_redraw = true;
+                            break;
+                        }
+                    }
+
+                    break;
+                }
                 case SDL_KEYDOWN:
                 {
                     switch (event.key.keysym.sym)
@@ -359,161 +543,748 @@ int main(int argc, char* argv[])
                         pitch_deg = 89.0f;
                     }
 
-                    const float yaw_rad = yaw_deg * M_PI / 180.0f;
-                    const float pitch_rad = pitch_deg * M_PI / 180.0f;
+                    ++motion_event_count;
+                    break;
+                }
+            }
+        }
 
-                    camera_dir.value[0] = sinf(yaw_rad) * cosf(pitch_rad);
-                    camera_dir.value[1] = sinf(pitch_rad);
-                    camera_dir.value[2] = -cosf(yaw_rad) * cosf(pitch_rad);
-                    camera_dir = vec3f_normalize(&camera_dir);
+        // The camera basis only depends on the final angles, so a burst of motion events costs one update
+        if (motion_event_count > 0)
+        {
+            const float yaw_rad = yaw_deg * M_PI / 180.0f;
+            const float pitch_rad = pitch_deg * M_PI / 180.0f;
 
-                    camera_right = vec3f_cross(&camera_dir, &world_up);
-                    camera_right = vec3f_normalize(&camera_right);
+            camera_dir.value[0] = sinf(yaw_rad) * cosf(pitch_rad);
+            camera_dir.value[1] = sinf(pitch_rad);
+            camera_dir.value[2] = -cosf(yaw_rad) * cosf(pitch_rad);
+            camera_dir = vec3f_normalize(&camera_dir);
 
-                    camera_up = vec3f_cross(&camera_right, &camera_dir);
+            camera_right = vec3f_cross(&camera_dir, &world_up);
+            camera_right = vec3f_normalize(&camera_right);
 
-                    {
-                        const float* const R = camera_right.value;
-                        const float* const U = camera_up.value;
-                        const float* const D = camera_dir.value;
-                        const float* const P = camera_pos.value;
-
-                        const Mat4f mat1 = {.value = {
-                            {R[0], R[1], R[2], 0.0f},
-                            {U[0], U[1], U[2], 0.0f},
-                            {D[0], D[1], D[2], 0.0f},
-                            {0.0f, 0.0f, 0.0f, 1.0f}
-                        }};
-
-                        const Mat4f mat2 = {.value = {
-                            {1.0f, 0.0f, 0.0f, -P[0]},
-                            {0.0f, 1.0f, 0.0f, -P[1]},
-                            {0.0f, 0.0f, 1.0f, -P[2]},
-                            {0.0f, 0.0f, 0.0f, 1.0f}
-                        }};
-
-                        look_at_matrix = mat4f_product(&mat1, &mat2);
-                    }
+            camera_up = vec3f_cross(&camera_right, &camera_dir);
 
-                    break;
+            look_at_matrix = mat4f_look_at(&camera_right, &camera_up, &camera_dir, &camera_pos);
+            camera.view = look_at_matrix;
+
+            coalesced_event_count += motion_event_count - 1;
+            last_motion_event_count = motion_event_count;
+            motion_event_count = 0;
+
+            needs_redraw = true;
+        }
+
+        frame_profiler_mark(&frame_profiler, FRAME_SECTION_EVENTS);
+
+        if (quit)
+        {
+            break;
+        }
+
+        SDL_GL_MakeCurrent(main_window, gl_context);
+
+        if (shader_watcher_poll(&shader_watcher) && !begin_program_builds(true))
+        {
+            fputs("Failed to reload shaders, keeping the previous programs\n", stderr);
+        }
+
+        // Keeps the loop polling, and the fallback or previous programs drawing, until the builds finish
+        if (are_programs_building)
+        {
+            if (poll_program_builds() == PROGRAM_BUILD_FAILED)
+            {
+                if (shader_program == 0)
+                {
+                    return EXIT_FAILURE;
                 }
+
+                fputs("Failed to reload shaders, keeping the previous programs\n", stderr);
             }
+
+            needs_redraw = true;
         }
 
-        SDL_GL_MakeCurrent(main_window, gl_context);
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        const bool has_gpu_result = gpu_timer_poll(&gpu_timer);
 
-        glUseProgram(shader_program);
-        glUniformMatrix4fv(view_location, 1, GL_FALSE, &look_at_matrix.value[0][0]);
-        glBindVertexArray(vao);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
+        const bool is_scene_dirty = !is_on_demand || needs_redraw;
+        if (!is_scene_dirty && !has_gpu_result)
+        {
+            continue;
+        }
 
-        SDL_GL_SwapWindow(main_window);
+        if (is_viewport_dirty)
+        {
+            SDL_GL_GetDrawableSize(main_window, &drawable_width, &drawable_height);
+            if (drawable_width > 0 && drawable_height > 0)
+            {
+                glViewport(0, 0, drawable_width, drawable_height);
+                if (!create_scene_framebuffer(drawable_width, drawable_height))
+                {
+                    return EXIT_FAILURE;
+                }
 
-        SDL_SetRenderTarget(renderer, NULL);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+                camera.projection = mat4f_perspective_reverse_z_infinite(CAMERA_FOV_Y_DEG * M_PI / 180.0f,
+                    (float)drawable_width / (float)drawable_height, CAMERA_NEAR_Z);
+            }
+            is_viewport_dirty = false;
+        }
 
-        render_text_vec3f("points[0]", &points[0], color_green, 10, 10);
-        render_text_vec3f("points[1]", &points[1], color_green, 10, 40);
-        render_text_vec3f("points[2]", &points[2], color_green, 10, 70);
-        render_text_vec3f("points[3]", &points[3], color_green, 10, 100);
-        render_text_vec3f("world_up ", &world_up, color_green, 10, 130);
-        render_text_float("yaw_deg", yaw_deg, color_orange, 10, 160);
-        render_text_float("pitch_deg", pitch_deg, color_orange, 286, 160);
-        render_text_vec3f("camera_pos  ", &camera_pos, color_blue, 10, 190);
-        render_text_vec3f("camera_dir  ", &camera_dir, color_blue, 10, 220);
-        render_text_vec3f("camera_right", &camera_right, color_blue, 10, 250);
-        render_text_vec3f("camera_up   ", &camera_up, color_blue, 10, 280);
-        render_text_mat4f("look_at", &look_at_matrix, color_orange, 10, 310);
+        // A late GPU timer result alone only refreshes the overlay
+        if (is_scene_dirty)
+        {
+            const Uint64 submit_start = SDL_GetPerformanceCounter();
 
-        SDL_RenderPresent(renderer);
-    }
+            gpu_timer_begin(&gpu_timer);
+            draw_scene(&camera);
+            gpu_timer_end(&gpu_timer);
 
-    return EXIT_SUCCESS;
-}
+            cpu_ms = (float)((double)(SDL_GetPerformanceCounter() - submit_start) * 1000.0
+                / (double)SDL_GetPerformanceFrequency());
 
-static float vec3f_get_length(const Vec3f* const vec)
-{
-    return sqrtf(vec->value[0] * vec->value[0] + vec->value[1] * vec->value[1] + vec->value[2] * vec->value[2]);
-}
+            frame_profiler_mark(&frame_profiler, FRAME_SECTION_SUBMIT);
 
-static Vec3f vec3f_normalize(const Vec3f* const vec)
-{
-    const float length = vec3f_get_length(vec);
+            SDL_GL_SwapWindow(main_window);
 
-    return (Vec3f){vec->value[0] / length, vec->value[1] / length, vec->value[2] / length};
-}
+            frame_profiler_mark(&frame_profiler, FRAME_SECTION_SWAP);
+        }
 
-static Vec3f vec3f_cross(const Vec3f* const vec1, const Vec3f* const vec2)
-{
-    return (Vec3f){
-        vec1->value[1] * vec2->value[2] - vec1->value[2] * vec2->value[1],
-        vec1->value[2] * vec2->value[0] - vec1->value[0] * vec2->value[2],
-        vec1->value[0] * vec2->value[1] - vec1->value[1] * vec2->value[0]
-    };
-}
+        needs_redraw = false;
 
-static Mat4f mat4f_product(const Mat4f* const mat1, const Mat4f* const mat2)
-{
-    Mat4f result;
-    for (int i = 0; i < 4; ++i)
-    {
-        for (int j = 0; j < 4; ++j)
+        if (--frames_until_stats <= 0)
         {
-            result.value[i][j] = 0.0f;
-            for (int k = 0; k < 4; ++k)
+            for (int i = 0; i < FRAME_SECTION_COUNT; ++i)
             {
-                result.value[i][j] += mat1->value[i][k] * mat2->value[k][j];
+                frame_profiler_compute_stats(&frame_profiler, (FrameSection)i, &frame_stats[i]);
             }
+
+            frames_until_stats = FRAME_STATS_INTERVAL;
         }
-    }
-    return result;
-}
 
-static void cleanup(void)
-{
-    if (renderer != NULL)
-    {
-        SDL_DestroyRenderer(renderer);
-    }
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
 
-    if (info_window != NULL)
-    {
-        SDL_DestroyWindow(info_window);
-    }
+        render_text_vec3f(INFO_LINE_POINTS_0, "points[0]", &points[0], color_green, 10, 10);
+        render_text_vec3f(INFO_LINE_POINTS_1, "points[1]", &points[1], color_green, 10, 40);
+        render_text_vec3f(INFO_LINE_POINTS_2, "points[2]", &points[2], color_green, 10, 70);
+        render_text_vec3f(INFO_LINE_POINTS_3, "points[3]", &points[3], color_green, 10, 100);
+        render_text_vec3f(INFO_LINE_WORLD_UP, "world_up ", &world_up, color_green, 10, 130);
+        render_text_float(INFO_LINE_YAW_DEG, "yaw_deg", yaw_deg, color_orange, 10, 160);
+        render_text_float(INFO_LINE_PITCH_DEG, "pitch_deg", pitch_deg, color_orange, 286, 160);
+        render_text_vec3f(INFO_LINE_CAMERA_POS, "camera_pos  ", &camera_pos, color_blue, 10, 190);
+        render_text_vec3f(INFO_LINE_CAMERA_DIR, "camera_dir  ", &camera_dir, color_blue, 10, 220);
+        render_text_vec3f(INFO_LINE_CAMERA_RIGHT, "camera_right", &camera_right, color_blue, 10, 250);
+        render_text_vec3f(INFO_LINE_CAMERA_UP, "camera_up   ", &camera_up, color_blue, 10, 280);
+        render_text_mat4f(INFO_LINE_LOOK_AT, "look_at", &look_at_matrix, color_orange, 10, 310);
+        render_text_float(INFO_LINE_MOTION_EVENTS, "motion", (float)last_motion_event_count,
+            color_green, 10, 490);
+        render_text_float(INFO_LINE_COALESCED_EVENTS, "coalesced", (float)coalesced_event_count,
+            color_green, 286, 490);
+        render_text_float(INFO_LINE_CPU_MS, "cpu_ms", cpu_ms, color_green, 10, 520);
+        render_text_float(INFO_LINE_GPU_MS, "gpu_ms", (float)gpu_timer.last_gpu_ms, color_green, 286, 520);
+        render_text_stats(INFO_LINE_EVENTS_STATS, "events", &frame_stats[FRAME_SECTION_EVENTS],
+            color_blue, 10, 550);
+        render_text_stats(INFO_LINE_SUBMIT_STATS, "submit", &frame_stats[FRAME_SECTION_SUBMIT],
+            color_blue, 10, 580);
+        render_text_stats(INFO_LINE_SWAP_STATS, "swap  ", &frame_stats[FRAME_SECTION_SWAP],
+            color_blue, 10, 610);
+        render_text_stats(INFO_LINE_INFO_STATS, "info  ", &frame_stats[FRAME_SECTION_INFO],
+            color_blue, 10, 640);
+        render_text_stats(INFO_LINE_FRAME_STATS, "frame ", &frame_stats[FRAME_SECTION_FRAME],
+            color_orange, 10, 670);
+        render_text_histogram(INFO_LINE_FRAME_HISTOGRAM, "frame ", &frame_stats[FRAME_SECTION_FRAME],
+            color_orange, 10, 700);
+        render_text_float(INFO_LINE_VISIBLE_OBJECTS, "visible", (float)visible_object_count, color_green, 10, 730);
+        render_text_float(INFO_LINE_CULLED_OBJECTS, "culled", (float)(scene.object_count - visible_object_count),
+            color_green, 286, 730);
+
+        glyph_atlas_draw(&glyph_atlas, renderer, &text_geometry);
+        text_geometry_clear(&text_geometry);
 
-    if (vao != 0)
-    {
-        glDeleteVertexArrays(1, &vao);
-    }
+        SDL_RenderPresent(renderer);
 
-    if (ebo != 0)
-    {
-        glDeleteBuffers(1, &ebo);
+        frame_profiler_mark(&frame_profiler, FRAME_SECTION_INFO);
+        frame_profiler_end_frame(&frame_profiler);
     }
 
-    if (vbo != 0)
+    if (profile_output_path != NULL && !frame_profiler_dump(&frame_profiler, profile_output_path))
     {
-        glDeleteBuffers(1, &vbo);
+        return EXIT_FAILURE;
     }
 
-    if (shader_program != 0)
-    {
-        glDeleteProgram(shader_program);
-    }
+    return EXIT_SUCCESS;
+}
+
+static bool create_main_window(void)
+{
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 6);
+
+#ifdef SDL_HINT_IME_SHOW_UI
+    SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
+#endif
+
+    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+    // Depth lives in the scene framebuffer, the window's only receives the finished color
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 0);
+    SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 0);
+
+    main_window = SDL_CreateWindow("Main", 20, 20, 900, 900, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+    if (main_window == NULL)
+    {
+        fputs("Failed to create main window\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    gl_context = SDL_GL_CreateContext(main_window);
+    if (gl_context == NULL)
+    {
+        fputs("Failed to create OpenGL context\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+        return false;
+    }
 
-    if (fragment_shader != 0)
+    if (!gladLoadGLLoader(SDL_GL_GetProcAddress))
     {
-        glDeleteShader(fragment_shader);
+        fputs("Failed to initialize glad\n", stderr);
+        return false;
     }
 
-    if (vertex_shader != 0)
+    program_build_init(SDL_GL_GetProcAddress);
+
+    return true;
+}
+
+static bool create_headless_context(void)
+{
+#ifdef TEST_MATRIX_HEADLESS
+    if (!headless_context_create(&headless_context, HEADLESS_WIDTH, HEADLESS_HEIGHT))
     {
-        glDeleteShader(vertex_shader);
+        return false;
     }
 
+    program_build_init(headless_get_proc_address);
+
+    return true;
+#else
+    fputs("Headless mode requires EGL, which was not found at build time\n", stderr);
+    return false;
+#endif
+}
+
+static bool begin_program_builds(const bool is_from_disk)
+{
+    // The GPU culled scene reads its models from a storage buffer rather than streamed instance attributes
+    const char* const scene_shader_names[] = {
+        is_gpu_culling ? "shaders/shader_gpu_cull.vert" : "shaders/shader.vert",
+        "shaders/shader.frag"
+    };
+    const GLenum scene_shader_types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+
+    const char* const cull_shader_names[] = {"shaders/cull.comp"};
+    const GLenum cull_shader_types[] = {GL_COMPUTE_SHADER};
+
+    // A newer edit supersedes builds still in flight
+    cancel_program_builds();
+
+    // Everything is submitted before anything is waited for, so the driver compiles the programs in parallel
+    if (!begin_program_build(&scene_program_build, scene_shader_names, scene_shader_types,
+        sizeof(scene_shader_names) / sizeof(scene_shader_names[0]), is_from_disk))
+    {
+        return false;
+    }
+
+    if (is_gpu_culling && !begin_program_build(&cull_program_build, cull_shader_names, cull_shader_types,
+        sizeof(cull_shader_names) / sizeof(cull_shader_names[0]), is_from_disk))
+    {
+        cancel_program_builds();
+        return false;
+    }
+
+    are_programs_building = true;
+
+    return true;
+}
+
+// Swaps every built program in at once, so a failed build, e.g. from a broken shader edit, leaves the
+// previous programs in place. Uniforms and blocks have explicit locations and bindings, so the new
+// programs need no lookups.
+static ProgramBuildStatus poll_program_builds(void)
+{
+    const ProgramBuildStatus scene_status = program_build_poll(&scene_program_build, &program_cache);
+    const ProgramBuildStatus cull_status = is_gpu_culling
+        ? program_build_poll(&cull_program_build, &program_cache)
+        : PROGRAM_BUILD_DONE;
+
+    if (scene_status == PROGRAM_BUILD_FAILED || cull_status == PROGRAM_BUILD_FAILED)
+    {
+        cancel_program_builds();
+        return PROGRAM_BUILD_FAILED;
+    }
+
+    if (scene_status == PROGRAM_BUILD_PENDING || cull_status == PROGRAM_BUILD_PENDING)
+    {
+        return PROGRAM_BUILD_PENDING;
+    }
+
+    if (shader_program != 0)
+    {
+        glDeleteProgram(shader_program);
+    }
+    shader_program = scene_program_build.program;
+
+    if (cull_program != 0)
+    {
+        glDeleteProgram(cull_program);
+    }
+    cull_program = cull_program_build.program;
+
+    // The programs belong to the globals now
+    memset(&scene_program_build, 0, sizeof(scene_program_build));
+    memset(&cull_program_build, 0, sizeof(cull_program_build));
+    are_programs_building = false;
+
+    return PROGRAM_BUILD_DONE;
+}
+
+static void cancel_program_builds(void)
+{
+    program_build_cancel(&cull_program_build);
+    program_build_cancel(&scene_program_build);
+    are_programs_building = false;
+}
+
+static bool create_scene(void)
+{
+    char* const pref_path = SDL_GetPrefPath("test_matrix", "test_matrix");
+    if (pref_path == NULL)
+    {
+        fputs("Failed to get pref path, shader programs won't be cached\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+    }
+    else
+    {
+        const bool is_cache_created = program_cache_create(&program_cache, pref_path);
+        SDL_free(pref_path);
+        if (!is_cache_created)
+        {
+            return false;
+        }
+    }
+
+    // The programs compile while the scene is set up and the first frames show the fallback
+    if (!begin_program_builds(false))
+    {
+        return false;
+    }
+
+    if (mesh_path_count == 0)
+    {
+        for (size_t i = 0; i < sizeof(default_mesh_names) / sizeof(default_mesh_names[0]); ++i)
+        {
+            Resource resource;
+            if (!find_resource(default_mesh_names[i], &resource)
+                || !mesh_file_open_memory(&mesh_files[mesh_file_count], resource.data, resource.size,
+                    default_mesh_names[i]))
+            {
+                return false;
+            }
+
+            ++mesh_file_count;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < mesh_path_count; ++i)
+        {
+            if (!mesh_file_open(&mesh_files[mesh_file_count], mesh_paths[i]))
+            {
+                return false;
+            }
+
+            ++mesh_file_count;
+        }
+    }
+
+    int meshes[1 + MESH_PATH_CAPACITY];
+    int mesh_count = 0;
+
+    meshes[mesh_count++] = scene_add_mesh(&scene, vertices, sizeof(vertices) / sizeof(vertices[0]),
+        indices, sizeof(indices) / sizeof(indices[0]));
+
+    for (int i = 0; i < mesh_file_count; ++i)
+    {
+        meshes[mesh_count++] = scene_add_mesh(&scene, (const SceneVertex*)mesh_files[i].vertices,
+            (int)mesh_files[i].vertex_count, mesh_files[i].indices, (int)mesh_files[i].index_count);
+    }
+
+    for (int i = 0; i < mesh_count; ++i)
+    {
+        if (meshes[i] < 0)
+        {
+            return false;
+        }
+    }
+
+    // Lay the objects out on a square grid covering clip space, cycling through the meshes; a single
+    // object is the untransformed quad
+    const int grid_size = (int)ceilf(sqrtf((float)instance_count));
+    const float cell_size = 2.0f / (float)grid_size;
+    const float scale = fminf(1.0f, 0.8f * cell_size);
+
+    for (int i = 0; i < instance_count; ++i)
+    {
+        const float x = -1.0f + cell_size * ((float)(i % grid_size) + 0.5f);
+        const float y = -1.0f + cell_size * ((float)(i / grid_size) + 0.5f);
+
+        const Mat4f model = {.value = {
+            {scale, 0.0f, 0.0f, x},
+            {0.0f, scale, 0.0f, y},
+            {0.0f, 0.0f, scale, 0.0f},
+            {0.0f, 0.0f, 0.0f, 1.0f}
+        }};
+
+        if (!scene_add_object(&scene, meshes[i % mesh_count], &model))
+        {
+            return false;
+        }
+    }
+
+    if (!scene_upload(&scene, is_gpu_culling))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < mesh_file_count; ++i)
+    {
+        mesh_file_close(&mesh_files[i]);
+    }
+    mesh_file_count = 0;
+
+    // One region holds a frame's camera block and everything the scene streams, plus alignment padding
+    if (!gl_ring_buffer_create(&ring_buffer, sizeof(CameraBlock) + scene_get_frame_stream_size(&scene) + 1024))
+    {
+        return false;
+    }
+
+    // Reverse-Z: depth 1 at the near plane and 0 at infinity, which spends float precision evenly
+    glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_GREATER);
+    glClearDepth(0.0);
+
+    return true;
+}
+
+static bool create_scene_framebuffer(const int width, const int height)
+{
+    if (scene_framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &scene_framebuffer);
+        glDeleteRenderbuffers(1, &scene_depth_renderbuffer);
+        glDeleteRenderbuffers(1, &scene_color_renderbuffer);
+    }
+
+    scene_width = width;
+    scene_height = height;
+
+    glGenRenderbuffers(1, &scene_color_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, scene_color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &scene_depth_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, scene_depth_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+
+    glGenFramebuffers(1, &scene_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, scene_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, scene_color_renderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, scene_depth_renderbuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fputs("Failed to create scene framebuffer\n", stderr);
+        return false;
+    }
+
+    return true;
+}
+
+static bool create_info_window(void)
+{
+    if (TTF_Init() < 0)
+    {
+        fputs("Failed to initialize SDL_ttf\n", stderr);
+        fprintf(stderr, "TTF error: %s\n", TTF_GetError());
+        return false;
+    }
+
+    const char* const font_name = "fonts/IosevkaNerdFont-Regular.ttf";
+
+    Resource font_resource;
+    if (!find_resource(font_name, &font_resource))
+    {
+        return false;
+    }
+
+    // The pack stays mapped for as long as the font is open
+    font = TTF_OpenFontRW(SDL_RWFromConstMem(font_resource.data, (int)font_resource.size), 1, 24);
+    if (font == NULL)
+    {
+        fprintf(stderr, "Failed to open font %s\n", font_name);
+        fprintf(stderr, "TTF error: %s\n", TTF_GetError());
+        return false;
+    }
+
+    info_window = SDL_CreateWindow("Info", 940, 20, 900, 900, SDL_WINDOW_RESIZABLE);
+    if (info_window == NULL)
+    {
+        fputs("Failed to create info window\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    renderer = SDL_CreateRenderer(info_window, -1, SDL_RENDERER_ACCELERATED);
+    if (renderer == NULL)
+    {
+        fputs("Failed to create renderer\n", stderr);
+        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
+        return false;
+    }
+
+    if (!glyph_atlas_create(&glyph_atlas, renderer, font))
+    {
+        return false;
+    }
+
+    // The renderer may have switched to its own GL context
+    SDL_GL_MakeCurrent(main_window, gl_context);
+
+    return true;
+}
+
+static void draw_scene(const CameraBlock* const camera)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, scene_framebuffer);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Until the first programs are built, the fallback is the bare clear color
+    if (shader_program != 0)
+    {
+        draw_objects(camera);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, scene_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, present_framebuffer);
+    glBlitFramebuffer(0, 0, scene_width, scene_height, 0, 0, scene_width, scene_height, GL_COLOR_BUFFER_BIT,
+        GL_NEAREST);
+}
+
+static void draw_objects(const CameraBlock* const camera)
+{
+    glUseProgram(shader_program);
+
+    if (!gl_ring_buffer_begin_frame(&ring_buffer))
+    {
+        return;
+    }
+
+    GLintptr camera_offset;
+    CameraBlock* const camera_block = gl_ring_buffer_allocate(&ring_buffer, sizeof(CameraBlock), &camera_offset);
+    if (camera_block == NULL)
+    {
+        return;
+    }
+
+    *camera_block = *camera;
+    glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, ring_buffer.buffer, camera_offset,
+        sizeof(CameraBlock));
+
+    const Mat4f view_projection = mat4f_product(&camera->projection, &camera->view);
+
+    Frustum frustum;
+    frustum_from_matrix(&frustum, &view_projection);
+
+    if (is_gpu_culling)
+    {
+        scene_cull_gpu(&scene, cull_program, &ring_buffer, &frustum, &visible_object_count);
+
+        glUseProgram(shader_program);
+        scene_draw_gpu_culled(&scene);
+    }
+    else
+    {
+        scene_draw(&scene, &ring_buffer, &frustum, &visible_object_count);
+    }
+
+    gl_ring_buffer_end_frame(&ring_buffer);
+}
+
+static bool run_headless(const CameraBlock* const camera)
+{
+    if (headless_frame_count <= 0)
+    {
+        fputs("Frame count must be positive\n", stderr);
+        return false;
+    }
+
+    // The run measures the scene, not the fallback
+    while (are_programs_building)
+    {
+        const ProgramBuildStatus build_status = poll_program_builds();
+        if (build_status == PROGRAM_BUILD_FAILED)
+        {
+            return false;
+        }
+
+        if (build_status == PROGRAM_BUILD_PENDING)
+        {
+            SDL_Delay(1);
+        }
+    }
+
+    double* const frame_times_ms = malloc(headless_frame_count * sizeof(double));
+    if (frame_times_ms == NULL)
+    {
+        fputs("Failed to allocate memory for frame times\n", stderr);
+        return false;
+    }
+
+    const double counter_to_ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    // Warmup frame: absorbs lazy driver work like shader variant compilation, and the first timer
+    // query, which some drivers report garbage for
+    gpu_timer_begin(&gpu_timer);
+    draw_scene(camera);
+    gpu_timer_end(&gpu_timer);
+    glFinish();
+    gpu_timer_poll(&gpu_timer);
+
+    double gpu_total_ms = 0.0;
+    int gpu_result_count = 0;
+
+    for (int i = 0; i < headless_frame_count; ++i)
+    {
+        const Uint64 frame_start = SDL_GetPerformanceCounter();
+        frame_profiler_begin_frame(&frame_profiler);
+
+        gpu_timer_begin(&gpu_timer);
+        draw_scene(camera);
+        gpu_timer_end(&gpu_timer);
+
+        frame_profiler_mark(&frame_profiler, FRAME_SECTION_SUBMIT);
+
+        // Without a swap nothing paces the GPU, so wait for each frame to actually finish
+        glFinish();
+
+        frame_profiler_mark(&frame_profiler, FRAME_SECTION_SWAP);
+        frame_profiler_end_frame(&frame_profiler);
+
+        frame_times_ms[i] = (double)(SDL_GetPerformanceCounter() - frame_start) * counter_to_ms;
+
+        if (gpu_timer_poll(&gpu_timer))
+        {
+            gpu_total_ms += gpu_timer.last_gpu_ms;
+            ++gpu_result_count;
+        }
+    }
+
+    double total_ms = 0.0;
+    double min_ms = frame_times_ms[0];
+    double max_ms = frame_times_ms[0];
+    for (int i = 0; i < headless_frame_count; ++i)
+    {
+        total_ms += frame_times_ms[i];
+        if (frame_times_ms[i] < min_ms)
+        {
+            min_ms = frame_times_ms[i];
+        }
+        if (frame_times_ms[i] > max_ms)
+        {
+            max_ms = frame_times_ms[i];
+        }
+    }
+
+    const double mean_ms = total_ms / headless_frame_count;
+    const double gpu_mean_ms = gpu_result_count > 0 ? gpu_total_ms / gpu_result_count : 0.0;
+
+    printf("renderer=\"%s\" instances=%d visible=%d frames=%d total_ms=%.3f mean_ms=%.4f min_ms=%.4f "
+        "max_ms=%.4f fps=%.1f gpu_mean_ms=%.4f\n",
+        (const char*)glGetString(GL_RENDERER), instance_count, visible_object_count, headless_frame_count,
+        total_ms, mean_ms, min_ms, max_ms, 1000.0 / mean_ms, gpu_mean_ms);
+
+    free(frame_times_ms);
+
+    return true;
+}
+
+static void cleanup(void)
+{
+    shader_watcher_destroy(&shader_watcher);
+
+    for (int i = 0; i < INFO_LINE_COUNT; ++i)
+    {
+        text_line_destroy(&info_lines[i]);
+    }
+
+    text_geometry_destroy(&text_geometry);
+    glyph_atlas_destroy(&glyph_atlas);
+
+    if (renderer != NULL)
+    {
+        SDL_DestroyRenderer(renderer);
+    }
+
+    if (info_window != NULL)
+    {
+        SDL_DestroyWindow(info_window);
+    }
+
+    gpu_timer_destroy(&gpu_timer);
+
+    gl_ring_buffer_destroy(&ring_buffer);
+
+    if (scene_framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &scene_framebuffer);
+    }
+
+    if (scene_depth_renderbuffer != 0)
+    {
+        glDeleteRenderbuffers(1, &scene_depth_renderbuffer);
+    }
+
+    if (scene_color_renderbuffer != 0)
+    {
+        glDeleteRenderbuffers(1, &scene_color_renderbuffer);
+    }
+
+    scene_destroy(&scene);
+
+    for (int i = 0; i < mesh_file_count; ++i)
+    {
+        mesh_file_close(&mesh_files[i]);
+    }
+
+    cancel_program_builds();
+
+    if (cull_program != 0)
+    {
+        glDeleteProgram(cull_program);
+    }
+
+    if (shader_program != 0)
+    {
+        glDeleteProgram(shader_program);
+    }
+
+    program_cache_destroy(&program_cache);
+
     if (gl_context != NULL)
     {
         SDL_GL_DeleteContext(gl_context);
@@ -524,12 +1295,16 @@ static void cleanup(void)
         SDL_DestroyWindow(main_window);
     }
 
+#ifdef TEST_MATRIX_HEADLESS
+    headless_context_destroy(&headless_context);
+#endif
+
     if (font != NULL)
     {
         TTF_CloseFont(font);
     }
 
-    free(absolute_font_path);
+    resource_pack_close(&resource_pack);
 
     if (absolute_bin_dir != NULL)
     {
@@ -556,113 +1331,172 @@ static char* get_absolute_path(const char* const relative_path)
     return absolute_path;
 }
 
-static GLuint load_shader(const char* const relative_path, const GLenum type)
+static bool find_resource(const char* const name, Resource* const resource)
 {
-    char* const absolute_shader_path = get_absolute_path(relative_path);
-    if (absolute_shader_path == NULL)
+    if (!resource_pack_find(&resource_pack, name, resource))
     {
-        return 0;
+        fprintf(stderr, "Failed to find %s in the resource pack\n", name);
+        return false;
     }
 
-    FILE* const shader_file = fopen(absolute_shader_path, "r");
-    free(absolute_shader_path);
-    if (shader_file == NULL)
+    return true;
+}
+
+static char* read_text_file(const char* const path)
+{
+    FILE* const file = fopen(path, "r");
+    if (file == NULL)
     {
-        fprintf(stderr, "Failed to open %s\n", relative_path);
-        return 0;
+        fprintf(stderr, "Failed to open %s\n", path);
+        return NULL;
     }
 
-    fseek(shader_file, 0, SEEK_END);
-    const long shader_code_length = ftell(shader_file);
+    fseek(file, 0, SEEK_END);
+    const long length = ftell(file);
 
-    char* const shader_code = malloc(shader_code_length + 1);
-    if (shader_code == NULL)
+    char* const text = malloc(length + 1);
+    if (text == NULL)
     {
-        fputs("Failed to allocate memory for shader code\n", stderr);
-        fclose(shader_file);
-        return 0;
+        fputs("Failed to allocate memory for file text\n", stderr);
+        fclose(file);
+        return NULL;
     }
 
-    fseek(shader_file, 0, SEEK_SET);
-    fread(shader_code, shader_code_length, 1, shader_file);
-    shader_code[shader_code_length] = '\0';
+    // Text mode may translate line endings, leaving fewer characters than the file size
+    fseek(file, 0, SEEK_SET);
+    const size_t read_length = fread(text, 1, length, file);
+    text[read_length] = '\0';
 
-    fclose(shader_file);
+    fclose(file);
 
-    const GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, (const GLchar* const *)&shader_code, NULL);
-    glCompileShader(shader);
+    return text;
+}
 
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success)
+// Hot reload reads the files being edited in the source tree, not the copies packed at build time
+static char* read_resource_source(const char* const name)
+{
+#ifdef TEST_MATRIX_EMBED_RESOURCES
+    fprintf(stderr, "Failed to read %s, embedded builds only have the resource pack\n", name);
+    return NULL;
+#else
+    const size_t path_size = sizeof(TEST_MATRIX_RESOURCE_SOURCE_DIR) + strlen(name);
+
+    char* const path = malloc(path_size);
+    if (path == NULL)
     {
-        GLchar info_log[512];
-        glGetShaderInfoLog(shader, 512, NULL, info_log);
-        fprintf(stderr, "Failed to compile %s\n", relative_path);
-        fprintf(stderr, "Info log: %s\n", info_log);
-        glDeleteShader(shader);
-        return 0;
+        fputs("Failed to allocate memory for resource source path\n", stderr);
+        return NULL;
     }
 
-    return shader;
+    snprintf(path, path_size, "%s%s", TEST_MATRIX_RESOURCE_SOURCE_DIR, name);
+
+    char* const text = read_text_file(path);
+    free(path);
+
+    return text;
+#endif
 }
 
-static bool render_text(const char* const text, const SDL_Color color, const int x, const int y)
+// Shaders come from the pack, or for hot reload from the source tree
+static bool begin_program_build(ProgramBuild* const build, const char* const* const names,
+    const GLenum* const types, const int shader_count, const bool is_from_disk)
 {
-    SDL_Surface* const text_surface = TTF_RenderUTF8_Blended_Wrapped(font, text, color, 0);
-    if (text_surface == NULL)
+    if (shader_count > PROGRAM_BUILD_SHADER_CAPACITY)
     {
-        fputs("Failed to create text surface\n", stderr);
-        fprintf(stderr, "TTF error: %s\n", TTF_GetError());
+        fputs("Too many shaders for one program\n", stderr);
         return false;
     }
 
-    SDL_Texture* const text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
-    SDL_FreeSurface(text_surface);
-    if (text_texture == NULL)
+    const char* sources[PROGRAM_BUILD_SHADER_CAPACITY] = {0};
+    char* disk_sources[PROGRAM_BUILD_SHADER_CAPACITY] = {0};
+    bool success = true;
+
+    for (int i = 0; success && i < shader_count; ++i)
     {
-        fputs("Failed to create texture from text surface\n", stderr);
-        fprintf(stderr, "SDL error: %s\n", SDL_GetError());
-        return false;
+        if (is_from_disk)
+        {
+            disk_sources[i] = read_resource_source(names[i]);
+            sources[i] = disk_sources[i];
+            success = sources[i] != NULL;
+        }
+        else
+        {
+            // Every resource in the pack is followed by a zero byte, so shaders are C strings in place
+            Resource resource;
+            success = find_resource(names[i], &resource);
+            sources[i] = resource.data;
+        }
+    }
+
+    // GL copies the sources, so they can go right after
+    if (success)
+    {
+        success = program_build_begin(build, &program_cache, sources, types, names, shader_count);
     }
 
-    SDL_Rect dstrect;
-    dstrect.x = x;
-    dstrect.y = y;
-    SDL_QueryTexture(text_texture, NULL, NULL, &dstrect.w, &dstrect.h);
+    for (int i = 0; i < shader_count; ++i)
+    {
+        free(disk_sources[i]);
+    }
 
-    SDL_RenderCopy(renderer, text_texture, NULL, &dstrect);
+    return success;
+}
 
-    SDL_DestroyTexture(text_texture);
+static bool render_text(TextLine* const line, const TextLineKey* const key, const char* const text)
+{
+    if (!text_line_update(line, &glyph_atlas, key, text))
+    {
+        return false;
+    }
 
-    return true;
+    return text_line_append(line, &text_geometry);
 }
 
-static bool render_text_float(const char* const name, const float value,
+static bool render_text_float(const InfoLine line, const char* const name, const float value,
     const SDL_Color color, const int x, const int y)
 {
+    TextLineKey key;
+    text_line_key_init(&key, &value, 1, color, x, y);
+    if (!text_line_is_dirty(&info_lines[line], &key))
+    {
+        return text_line_append(&info_lines[line], &text_geometry);
+    }
+
     char text[512];
-    snprintf(text, 512, "%s = %9.3f", name, value);
+    snprintf(text, 512, "%s = %9.3f", name, key.values[0]);
 
-    return render_text(text, color, x, y);
+    return render_text(&info_lines[line], &key, text);
 }
 
-static bool render_text_vec3f(const char* const name, const Vec3f* const vec,
+static bool render_text_vec3f(const InfoLine line, const char* const name, const Vec3f* const vec,
     const SDL_Color color, const int x, const int y)
 {
+    TextLineKey key;
+    text_line_key_init(&key, vec->value, 3, color, x, y);
+    if (!text_line_is_dirty(&info_lines[line], &key))
+    {
+        return text_line_append(&info_lines[line], &text_geometry);
+    }
+
     char format[512];
     snprintf(format, 512, "%s = {%%9.3f, %%9.3f, %%9.3f}", name);
 
     char text[512];
-    snprintf(text, 512, format, vec->value[0], vec->value[1], vec->value[2]);
+    snprintf(text, 512, format, key.values[0], key.values[1], key.values[2]);
 
-    return render_text(text, color, x, y);
+    return render_text(&info_lines[line], &key, text);
 }
 
-static bool render_text_mat4f(const char* const name, const Mat4f* const mat,
+static bool render_text_mat4f(const InfoLine line, const char* const name, const Mat4f* const mat,
     const SDL_Color color, const int x, const int y)
 {
+    TextLineKey key;
+    text_line_key_init(&key, &mat->value[0][0], 16, color, x, y);
+    if (!text_line_is_dirty(&info_lines[line], &key))
+    {
+        return text_line_append(&info_lines[line], &text_geometry);
+    }
+
     char format[512];
     snprintf(format, 512, "%s = {\n"
         "    %%9.3f, %%9.3f, %%9.3f, %%9.3f,\n"
@@ -672,10 +1506,72 @@ static bool render_text_mat4f(const char* const name, const Mat4f* const mat,
     "}", name);
 
     char text[512];
-    snprintf(text, 512, format, mat->value[0][0], mat->value[0][1], mat->value[0][2], mat->value[0][3],
-        mat->value[1][0], mat->value[1][1], mat->value[1][2], mat->value[1][3],
-        mat->value[2][0], mat->value[2][1], mat->value[2][2], mat->value[2][3],
-        mat->value[3][0], mat->value[3][1], mat->value[3][2], mat->value[3][3]);
+    snprintf(text, 512, format, key.values[0], key.values[1], key.values[2], key.values[3],
+        key.values[4], key.values[5], key.values[6], key.values[7],
+        key.values[8], key.values[9], key.values[10], key.values[11],
+        key.values[12], key.values[13], key.values[14], key.values[15]);
+
+    return render_text(&info_lines[line], &key, text);
+}
+
+static bool render_text_stats(const InfoLine line, const char* const name, const FrameStats* const stats,
+    const SDL_Color color, const int x, const int y)
+{
+    const float values[] = {stats->p50_ms, stats->p95_ms, stats->p99_ms};
+
+    TextLineKey key;
+    text_line_key_init(&key, values, 3, color, x, y);
+    if (!text_line_is_dirty(&info_lines[line], &key))
+    {
+        return text_line_append(&info_lines[line], &text_geometry);
+    }
+
+    char text[512];
+    snprintf(text, 512, "%s p50 = %7.3f  p95 = %7.3f  p99 = %7.3f", name, values[0], values[1], values[2]);
+
+    return render_text(&info_lines[line], &key, text);
+}
+
+static bool render_text_histogram(const InfoLine line, const char* const name, const FrameStats* const stats,
+    const SDL_Color color, const int x, const int y)
+{
+    float values[FRAME_HISTOGRAM_BUCKET_COUNT];
+    int max_count = 0;
+    for (int i = 0; i < FRAME_HISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        values[i] = (float)stats->histogram[i];
+        if (stats->histogram[i] > max_count)
+        {
+            max_count = stats->histogram[i];
+        }
+    }
+
+    TextLineKey key;
+    text_line_key_init(&key, values, FRAME_HISTOGRAM_BUCKET_COUNT, color, x, y);
+    if (!text_line_is_dirty(&info_lines[line], &key))
+    {
+        return text_line_append(&info_lines[line], &text_geometry);
+    }
+
+    // One character per bucket, denser characters for fuller buckets
+    static const char levels[] = " .:-=+*#%@";
+    const int level_count = (int)sizeof(levels) - 1;
+
+    char bars[FRAME_HISTOGRAM_BUCKET_COUNT + 1];
+    for (int i = 0; i < FRAME_HISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        int level = 0;
+        if (stats->histogram[i] > 0)
+        {
+            level = 1 + stats->histogram[i] * (level_count - 2) / max_count;
+        }
+        bars[i] = levels[level];
+    }
+    bars[FRAME_HISTOGRAM_BUCKET_COUNT] = '\0';
+
+    char text[512];
+    snprintf(text, 512, "%s hist [%s] 0..%.0f ms", name, bars,
+        FRAME_HISTOGRAM_BUCKET_COUNT * FRAME_HISTOGRAM_BUCKET_MS);
 
-    return render_text(text, color, x, y);
+    return render_text(&info_lines[line], &key, text);
 }
@@ -0,0 +1,390 @@
+#include "test_matrix/mat4f.h"
+
+#include "test_matrix/cpu_features.h"
+#include "test_matrix/vec3f.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#if CPU_FEATURES_SSE2
+#include <immintrin.h>
+#endif
+
+static void mat4f_select_kernels(void);
+
+static Mat4f mat4f_product_resolve(const Mat4f* const mat1, const Mat4f* const mat2);
+
+static void mat4f_transform_points_resolve(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out,
+    const size_t count);
+
+static void mat4f_transform_points_soa_resolve(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count);
+
+// Each starts out as a stub that picks the fastest kernels the CPU supports on first use
+static Mat4fProductFn mat4f_product_kernel = mat4f_product_resolve;
+static Mat4fTransformPointsFn mat4f_transform_points_kernel = mat4f_transform_points_resolve;
+static Mat4fTransformPointsSoaFn mat4f_transform_points_soa_kernel = mat4f_transform_points_soa_resolve;
+
+static const char* mat4f_product_kernel_name_value = NULL;
+static const char* mat4f_transform_points_kernel_name_value = NULL;
+static const char* mat4f_transform_points_soa_kernel_name_value = NULL;
+
+Mat4f mat4f_product(const Mat4f* const mat1, const Mat4f* const mat2)
+{
+    return mat4f_product_kernel(mat1, mat2);
+}
+
+void mat4f_transform_points(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out, const size_t count)
+{
+    mat4f_transform_points_kernel(mat, in, out, count);
+}
+
+void mat4f_transform_points_soa(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count)
+{
+    mat4f_transform_points_soa_kernel(mat, in_x, in_y, in_z, out_x, out_y, out_z, count);
+}
+
+const char* mat4f_product_kernel_name(void)
+{
+    if (mat4f_product_kernel_name_value == NULL)
+    {
+        mat4f_select_kernels();
+    }
+
+    return mat4f_product_kernel_name_value;
+}
+
+const char* mat4f_transform_points_kernel_name(void)
+{
+    if (mat4f_transform_points_kernel_name_value == NULL)
+    {
+        mat4f_select_kernels();
+    }
+
+    return mat4f_transform_points_kernel_name_value;
+}
+
+const char* mat4f_transform_points_soa_kernel_name(void)
+{
+    if (mat4f_transform_points_soa_kernel_name_value == NULL)
+    {
+        mat4f_select_kernels();
+    }
+
+    return mat4f_transform_points_soa_kernel_name_value;
+}
+
+Mat4f mat4f_transpose(const Mat4f* const mat)
+{
+    Mat4f result;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            result.value[i][j] = mat->value[j][i];
+        }
+    }
+
+    return result;
+}
+
+Mat4f mat4f_perspective(const float fov_y, const float aspect, const float near_z, const float far_z)
+{
+    const float focal_length = 1.0f / tanf(0.5f * fov_y);
+
+    return (Mat4f){.value = {
+        {focal_length / aspect, 0.0f, 0.0f, 0.0f},
+        {0.0f, focal_length, 0.0f, 0.0f},
+        {0.0f, 0.0f, (far_z + near_z) / (far_z - near_z), -2.0f * far_z * near_z / (far_z - near_z)},
+        {0.0f, 0.0f, 1.0f, 0.0f}
+    }};
+}
+
+Mat4f mat4f_perspective_reverse_z(const float fov_y, const float aspect, const float near_z, const float far_z)
+{
+    const float focal_length = 1.0f / tanf(0.5f * fov_y);
+
+    return (Mat4f){.value = {
+        {focal_length / aspect, 0.0f, 0.0f, 0.0f},
+        {0.0f, focal_length, 0.0f, 0.0f},
+        {0.0f, 0.0f, -near_z / (far_z - near_z), far_z * near_z / (far_z - near_z)},
+        {0.0f, 0.0f, 1.0f, 0.0f}
+    }};
+}
+
+Mat4f mat4f_perspective_reverse_z_infinite(const float fov_y, const float aspect, const float near_z)
+{
+    const float focal_length = 1.0f / tanf(0.5f * fov_y);
+
+    // The finite version's limit as the far plane goes to infinity
+    return (Mat4f){.value = {
+        {focal_length / aspect, 0.0f, 0.0f, 0.0f},
+        {0.0f, focal_length, 0.0f, 0.0f},
+        {0.0f, 0.0f, 0.0f, near_z},
+        {0.0f, 0.0f, 1.0f, 0.0f}
+    }};
+}
+
+Mat4f mat4f_look_at(const Vec3f* const right, const Vec3f* const up, const Vec3f* const dir, const Vec3f* const pos)
+{
+    const float* const R = right->value;
+    const float* const U = up->value;
+    const float* const D = dir->value;
+
+    return (Mat4f){.value = {
+        {R[0], R[1], R[2], -vec3f_dot(right, pos)},
+        {U[0], U[1], U[2], -vec3f_dot(up, pos)},
+        {D[0], D[1], D[2], -vec3f_dot(dir, pos)},
+        {0.0f, 0.0f, 0.0f, 1.0f}
+    }};
+}
+
+Mat4f mat4f_product_scalar(const Mat4f* const mat1, const Mat4f* const mat2)
+{
+    Mat4f result;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            result.value[i][j] = 0.0f;
+            for (int k = 0; k < 4; ++k)
+            {
+                result.value[i][j] += mat1->value[i][k] * mat2->value[k][j];
+            }
+        }
+    }
+    return result;
+}
+
+void mat4f_transform_points_scalar(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out,
+    const size_t count)
+{
+    const float (*const m)[4] = mat->value;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float x = in[i].value[0];
+        const float y = in[i].value[1];
+        const float z = in[i].value[2];
+
+        out[i].value[0] = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+        out[i].value[1] = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+        out[i].value[2] = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+    }
+}
+
+void mat4f_transform_points_soa_scalar(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count)
+{
+    const float (*const m)[4] = mat->value;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float x = in_x[i];
+        const float y = in_y[i];
+        const float z = in_z[i];
+
+        out_x[i] = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+        out_y[i] = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+        out_z[i] = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+    }
+}
+
+#if CPU_FEATURES_SSE2
+
+// Row i of the product is the sum of the rows of mat2 weighted by the elements of row i of mat1
+Mat4f mat4f_product_sse(const Mat4f* const mat1, const Mat4f* const mat2)
+{
+    const __m128 row0 = _mm_load_ps(mat2->value[0]);
+    const __m128 row1 = _mm_load_ps(mat2->value[1]);
+    const __m128 row2 = _mm_load_ps(mat2->value[2]);
+    const __m128 row3 = _mm_load_ps(mat2->value[3]);
+
+    Mat4f result;
+    for (int i = 0; i < 4; ++i)
+    {
+        __m128 row = _mm_mul_ps(_mm_set1_ps(mat1->value[i][0]), row0);
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(mat1->value[i][1]), row1));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(mat1->value[i][2]), row2));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(mat1->value[i][3]), row3));
+        _mm_store_ps(result.value[i], row);
+    }
+    return result;
+}
+
+// Four points at a time: deinterleave xyz triples into x, y and z lanes, transform, interleave back
+void mat4f_transform_points_sse(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out,
+    const size_t count)
+{
+    const float (*const m)[4] = mat->value;
+
+    const __m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]), m03 = _mm_set1_ps(m[0][3]);
+    const __m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]), m13 = _mm_set1_ps(m[1][3]);
+    const __m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]), m23 = _mm_set1_ps(m[2][3]);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* const src = in[i].value;
+        float* const dst = out[i].value;
+
+        // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+        const __m128 a = _mm_loadu_ps(src);
+        const __m128 b = _mm_loadu_ps(src + 4);
+        const __m128 c = _mm_loadu_ps(src + 8);
+
+        const __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+            _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+            _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+        const __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03));
+        const __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13));
+        const __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), m23));
+
+        const __m128 xy_lo = _mm_unpacklo_ps(tx, ty);
+        const __m128 xy_hi = _mm_unpackhi_ps(tx, ty);
+        const __m128 zx = _mm_shuffle_ps(tz, tx, _MM_SHUFFLE(1, 1, 0, 0));
+        const __m128 yz = _mm_shuffle_ps(ty, tz, _MM_SHUFFLE(1, 1, 1, 1));
+        const __m128 zxy = _mm_shuffle_ps(tz, xy_hi, _MM_SHUFFLE(3, 2, 3, 2));
+
+        _mm_storeu_ps(dst, _mm_shuffle_ps(xy_lo, zx, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(dst + 4, _mm_shuffle_ps(yz, xy_hi, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(dst + 8, _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(1, 3, 2, 0)));
+    }
+
+    mat4f_transform_points_scalar(mat, in + i, out + i, count - i);
+}
+
+void mat4f_transform_points_soa_sse(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count)
+{
+    const float (*const m)[4] = mat->value;
+
+    const __m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]), m03 = _mm_set1_ps(m[0][3]);
+    const __m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]), m13 = _mm_set1_ps(m[1][3]);
+    const __m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]), m23 = _mm_set1_ps(m[2][3]);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(in_x + i);
+        const __m128 y = _mm_loadu_ps(in_y + i);
+        const __m128 z = _mm_loadu_ps(in_z + i);
+
+        _mm_storeu_ps(out_x + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03)));
+        _mm_storeu_ps(out_y + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13)));
+        _mm_storeu_ps(out_z + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), m23)));
+    }
+
+    mat4f_transform_points_soa_scalar(mat, in_x + i, in_y + i, in_z + i, out_x + i, out_y + i, out_z + i, count - i);
+}
+
+// Same as the SSE kernel, but computes two rows of the product per iteration
+CPU_TARGET_AVX2 Mat4f mat4f_product_avx2(const Mat4f* const mat1, const Mat4f* const mat2)
+{
+    const __m256 row0 = _mm256_broadcast_ps((const __m128*)mat2->value[0]);
+    const __m256 row1 = _mm256_broadcast_ps((const __m128*)mat2->value[1]);
+    const __m256 row2 = _mm256_broadcast_ps((const __m128*)mat2->value[2]);
+    const __m256 row3 = _mm256_broadcast_ps((const __m128*)mat2->value[3]);
+
+    Mat4f result;
+    for (int i = 0; i < 4; i += 2)
+    {
+        // Rows are only 16-byte aligned, so a pair of them needs an unaligned load
+        const __m256 lhs = _mm256_loadu_ps(mat1->value[i]);
+
+        __m256 rows = _mm256_mul_ps(_mm256_shuffle_ps(lhs, lhs, 0x00), row0);
+        rows = _mm256_fmadd_ps(_mm256_shuffle_ps(lhs, lhs, 0x55), row1, rows);
+        rows = _mm256_fmadd_ps(_mm256_shuffle_ps(lhs, lhs, 0xAA), row2, rows);
+        rows = _mm256_fmadd_ps(_mm256_shuffle_ps(lhs, lhs, 0xFF), row3, rows);
+        _mm256_storeu_ps(result.value[i], rows);
+    }
+    return result;
+}
+
+CPU_TARGET_AVX2 void mat4f_transform_points_soa_avx2(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count)
+{
+    const float (*const m)[4] = mat->value;
+
+    const __m256 m00 = _mm256_set1_ps(m[0][0]), m01 = _mm256_set1_ps(m[0][1]), m02 = _mm256_set1_ps(m[0][2]), m03 = _mm256_set1_ps(m[0][3]);
+    const __m256 m10 = _mm256_set1_ps(m[1][0]), m11 = _mm256_set1_ps(m[1][1]), m12 = _mm256_set1_ps(m[1][2]), m13 = _mm256_set1_ps(m[1][3]);
+    const __m256 m20 = _mm256_set1_ps(m[2][0]), m21 = _mm256_set1_ps(m[2][1]), m22 = _mm256_set1_ps(m[2][2]), m23 = _mm256_set1_ps(m[2][3]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(in_x + i);
+        const __m256 y = _mm256_loadu_ps(in_y + i);
+        const __m256 z = _mm256_loadu_ps(in_z + i);
+
+        _mm256_storeu_ps(out_x + i, _mm256_fmadd_ps(m00, x, _mm256_fmadd_ps(m01, y, _mm256_fmadd_ps(m02, z, m03))));
+        _mm256_storeu_ps(out_y + i, _mm256_fmadd_ps(m10, x, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m12, z, m13))));
+        _mm256_storeu_ps(out_z + i, _mm256_fmadd_ps(m20, x, _mm256_fmadd_ps(m21, y, _mm256_fmadd_ps(m22, z, m23))));
+    }
+
+    mat4f_transform_points_soa_sse(mat, in_x + i, in_y + i, in_z + i, out_x + i, out_y + i, out_z + i, count - i);
+}
+
+#endif
+
+static void mat4f_select_kernels(void)
+{
+    mat4f_product_kernel = mat4f_product_scalar;
+    mat4f_transform_points_kernel = mat4f_transform_points_scalar;
+    mat4f_transform_points_soa_kernel = mat4f_transform_points_soa_scalar;
+    mat4f_product_kernel_name_value = "scalar";
+    mat4f_transform_points_kernel_name_value = "scalar";
+    mat4f_transform_points_soa_kernel_name_value = "scalar";
+
+#if CPU_FEATURES_SSE2
+    mat4f_product_kernel = mat4f_product_sse;
+    mat4f_transform_points_kernel = mat4f_transform_points_sse;
+    mat4f_transform_points_soa_kernel = mat4f_transform_points_soa_sse;
+    mat4f_product_kernel_name_value = "sse";
+    mat4f_transform_points_kernel_name_value = "sse";
+    mat4f_transform_points_soa_kernel_name_value = "sse";
+
+    const CpuFeatures* const features = cpu_features_get();
+    if (features->avx2 && features->fma)
+    {
+        // Interleaved points stay on the SSE kernel, deinterleaving eight of them costs more than it saves
+        mat4f_product_kernel = mat4f_product_avx2;
+        mat4f_transform_points_soa_kernel = mat4f_transform_points_soa_avx2;
+        mat4f_product_kernel_name_value = "avx2";
+        mat4f_transform_points_soa_kernel_name_value = "avx2";
+    }
+#endif
+}
+
+static Mat4f mat4f_product_resolve(const Mat4f* const mat1, const Mat4f* const mat2)
+{
+    mat4f_select_kernels();
+
+    return mat4f_product_kernel(mat1, mat2);
+}
+
+static void mat4f_transform_points_resolve(const Mat4f* const mat, const Vec3f* const in, Vec3f* const out,
+    const size_t count)
+{
+    mat4f_select_kernels();
+
+    mat4f_transform_points_kernel(mat, in, out, count);
+}
+
+static void mat4f_transform_points_soa_resolve(const Mat4f* const mat,
+    const float* const in_x, const float* const in_y, const float* const in_z,
+    float* const out_x, float* const out_y, float* const out_z, const size_t count)
+{
+    mat4f_select_kernels();
+
+    mat4f_transform_points_soa_kernel(mat, in_x, in_y, in_z, out_x, out_y, out_z, count);
+}
@@ -0,0 +1,107 @@
+#include "test_matrix/mesh_file.h"
+
+#include "test_matrix/file_mapping.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static bool mesh_file_init(MeshFile* const mesh, const unsigned char* const data, const size_t size,
+    const char* const name);
+
+static bool is_block_valid(const size_t size, const uint64_t offset, const uint32_t count,
+    const size_t element_size);
+
+bool mesh_file_open(MeshFile* const mesh, const char* const path)
+{
+    memset(mesh, 0, sizeof(*mesh));
+
+    if (!file_mapping_open(&mesh->mapping, path))
+    {
+        return false;
+    }
+
+    if (!mesh_file_init(mesh, mesh->mapping.data, mesh->mapping.size, path))
+    {
+        mesh_file_close(mesh);
+        return false;
+    }
+
+    return true;
+}
+
+bool mesh_file_open_memory(MeshFile* const mesh, const void* const data, const size_t size,
+    const char* const name)
+{
+    memset(mesh, 0, sizeof(*mesh));
+
+    if (!mesh_file_init(mesh, data, size, name))
+    {
+        mesh_file_close(mesh);
+        return false;
+    }
+
+    return true;
+}
+
+void mesh_file_close(MeshFile* const mesh)
+{
+    file_mapping_close(&mesh->mapping);
+    memset(mesh, 0, sizeof(*mesh));
+}
+
+static bool mesh_file_init(MeshFile* const mesh, const unsigned char* const data, const size_t size,
+    const char* const name)
+{
+    MeshFileHeader header;
+    if (size < sizeof(header))
+    {
+        fprintf(stderr, "Mesh file %s is truncated\n", name);
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != MESH_FILE_MAGIC || header.version != MESH_FILE_VERSION)
+    {
+        fprintf(stderr, "%s is not a version %u mesh file\n", name, MESH_FILE_VERSION);
+        return false;
+    }
+
+    if (!is_block_valid(size, header.vertex_offset, header.vertex_count, sizeof(MeshFileVertex))
+        || !is_block_valid(size, header.index_offset, header.index_count, sizeof(uint32_t))
+        || header.index_count % 3 != 0)
+    {
+        fprintf(stderr, "Mesh file %s has invalid blocks\n", name);
+        return false;
+    }
+
+    mesh->vertices = (const MeshFileVertex*)(data + header.vertex_offset);
+    mesh->vertex_count = header.vertex_count;
+    mesh->indices = (const uint32_t*)(data + header.index_offset);
+    mesh->index_count = header.index_count;
+
+    // GL would read out of bounds of the mesh's vertices otherwise
+    for (uint32_t i = 0; i < mesh->index_count; ++i)
+    {
+        if (mesh->indices[i] >= mesh->vertex_count)
+        {
+            fprintf(stderr, "Mesh file %s has an out of range index\n", name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool is_block_valid(const size_t size, const uint64_t offset, const uint32_t count,
+    const size_t element_size)
+{
+    if (offset % MESH_FILE_BLOCK_ALIGNMENT != 0 || offset > size)
+    {
+        return false;
+    }
+
+    return (uint64_t)count * element_size <= size - offset;
+}
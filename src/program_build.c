@@ -0,0 +1,199 @@
+#include "test_matrix/program_build.h"
+
+#include "glad/glad.h"
+#include "test_matrix/program_cache.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+static bool is_parallel_compile_supported = false;
+
+static bool has_extension(const char* const name);
+
+static void print_build_logs(const ProgramBuild* const build);
+
+void program_build_init(GLADloadproc load)
+{
+    const char* const function_name = has_extension("GL_KHR_parallel_shader_compile")
+        ? "glMaxShaderCompilerThreadsKHR"
+        : has_extension("GL_ARB_parallel_shader_compile") ? "glMaxShaderCompilerThreadsARB" : NULL;
+    if (function_name == NULL)
+    {
+        is_parallel_compile_supported = false;
+        return;
+    }
+
+    is_parallel_compile_supported = true;
+
+    // glad hands out object pointers, like the loaders it wraps
+    const void* const address = load(function_name);
+    if (address != NULL)
+    {
+        PFNGLMAXSHADERCOMPILERTHREADSKHRPROC max_shader_compiler_threads;
+        memcpy(&max_shader_compiler_threads, &address, sizeof(max_shader_compiler_threads));
+
+        // Lets the driver pick how many threads to use instead of its possibly conservative default
+        max_shader_compiler_threads(0xFFFFFFFFu);
+    }
+}
+
+bool program_build_begin(ProgramBuild* const build, const ProgramCache* const cache,
+    const char* const* const sources, const GLenum* const types, const char* const* const names,
+    const int shader_count)
+{
+    memset(build, 0, sizeof(*build));
+
+    if (shader_count > PROGRAM_BUILD_SHADER_CAPACITY)
+    {
+        fputs("Too many shaders for one program\n", stderr);
+        build->status = PROGRAM_BUILD_FAILED;
+        return false;
+    }
+
+    build->shader_count = shader_count;
+    for (int i = 0; i < shader_count; ++i)
+    {
+        build->names[i] = names[i];
+    }
+
+    build->cache_key = program_cache_key(cache, names, sources, shader_count);
+    build->status = PROGRAM_BUILD_PENDING;
+
+    build->program = program_cache_load(cache, &build->cache_key);
+    if (build->program != 0)
+    {
+        build->is_cached = true;
+        return true;
+    }
+
+    build->program = glCreateProgram();
+    program_cache_prepare(cache, build->program);
+
+    for (int i = 0; i < shader_count; ++i)
+    {
+        build->shaders[i] = glCreateShader(types[i]);
+        glShaderSource(build->shaders[i], 1, &sources[i], NULL);
+        glCompileShader(build->shaders[i]);
+        glAttachShader(build->program, build->shaders[i]);
+    }
+
+    // Linking without checking the compiles first queues the link behind them instead of waiting
+    glLinkProgram(build->program);
+
+    return true;
+}
+
+ProgramBuildStatus program_build_poll(ProgramBuild* const build, const ProgramCache* const cache)
+{
+    if (build->status != PROGRAM_BUILD_PENDING)
+    {
+        return build->status;
+    }
+
+    if (is_parallel_compile_supported)
+    {
+        GLint is_complete = GL_FALSE;
+        glGetProgramiv(build->program, GL_COMPLETION_STATUS_KHR, &is_complete);
+        if (!is_complete)
+        {
+            return PROGRAM_BUILD_PENDING;
+        }
+    }
+
+    GLint success;
+    glGetProgramiv(build->program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        print_build_logs(build);
+        program_build_cancel(build);
+        build->status = PROGRAM_BUILD_FAILED;
+        return build->status;
+    }
+
+    if (!build->is_cached)
+    {
+        program_cache_store(cache, &build->cache_key, build->program);
+    }
+
+    for (int i = 0; i < build->shader_count; ++i)
+    {
+        if (build->shaders[i] != 0)
+        {
+            glDetachShader(build->program, build->shaders[i]);
+            glDeleteShader(build->shaders[i]);
+            build->shaders[i] = 0;
+        }
+    }
+
+    build->status = PROGRAM_BUILD_DONE;
+    return build->status;
+}
+
+void program_build_cancel(ProgramBuild* const build)
+{
+    for (int i = 0; i < build->shader_count; ++i)
+    {
+        if (build->shaders[i] != 0)
+        {
+            glDeleteShader(build->shaders[i]);
+        }
+    }
+
+    if (build->program != 0)
+    {
+        glDeleteProgram(build->program);
+    }
+
+    memset(build, 0, sizeof(*build));
+}
+
+static bool has_extension(const char* const name)
+{
+    GLint extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+
+    for (GLint i = 0; i < extension_count; ++i)
+    {
+        const GLubyte* const extension = glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension != NULL && strcmp((const char*)extension, name) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// A failed link only says that something failed to compile, so the shader logs take precedence
+static void print_build_logs(const ProgramBuild* const build)
+{
+    GLchar info_log[512];
+    bool has_compile_error = false;
+
+    for (int i = 0; i < build->shader_count; ++i)
+    {
+        GLint success = GL_TRUE;
+        if (build->shaders[i] != 0)
+        {
+            glGetShaderiv(build->shaders[i], GL_COMPILE_STATUS, &success);
+        }
+
+        if (!success)
+        {
+            glGetShaderInfoLog(build->shaders[i], sizeof(info_log), NULL, info_log);
+            fprintf(stderr, "Failed to compile %s\n", build->names[i]);
+            fprintf(stderr, "Info log: %s\n", info_log);
+            has_compile_error = true;
+        }
+    }
+
+    if (!has_compile_error)
+    {
+        glGetProgramInfoLog(build->program, sizeof(info_log), NULL, info_log);
+        fprintf(stderr, "Failed to link program with %s\n", build->names[0]);
+        fprintf(stderr, "Info log: %s\n", info_log);
+    }
+}
@@ -0,0 +1,237 @@
+#include "test_matrix/program_cache.h"
+
+#include "glad/glad.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// "TMPB" read as a little-endian uint32_t
+#define PROGRAM_CACHE_MAGIC 0x42504D54u
+// Version 1 files were named by their source hash and had no version or hash in the header
+#define PROGRAM_CACHE_VERSION 2u
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325u
+#define FNV_PRIME 0x100000001B3u
+
+typedef struct ProgramCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t length;
+    uint64_t source_hash;
+} ProgramCacheHeader;
+
+static uint64_t hash_string(uint64_t hash, const char* const string);
+
+static char* get_cache_path(const ProgramCache* const cache, const ProgramCacheKey* const key);
+
+bool program_cache_create(ProgramCache* const cache, const char* const dir)
+{
+    memset(cache, 0, sizeof(*cache));
+
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (format_count == 0)
+    {
+        return true;
+    }
+
+    const size_t dir_size = strlen(dir) + 1;
+    cache->dir = malloc(dir_size);
+    if (cache->dir == NULL)
+    {
+        fputs("Failed to allocate memory for program cache dir\n", stderr);
+        return false;
+    }
+    memcpy(cache->dir, dir, dir_size);
+
+    const GLenum driver_strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+
+    cache->driver_hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < sizeof(driver_strings) / sizeof(driver_strings[0]); ++i)
+    {
+        const GLubyte* const string = glGetString(driver_strings[i]);
+        cache->driver_hash = hash_string(cache->driver_hash, string != NULL ? (const char*)string : "");
+    }
+
+    return true;
+}
+
+void program_cache_destroy(ProgramCache* const cache)
+{
+    free(cache->dir);
+    memset(cache, 0, sizeof(*cache));
+}
+
+ProgramCacheKey program_cache_key(const ProgramCache* const cache, const char* const* const names,
+    const char* const* const sources, const int shader_count)
+{
+    ProgramCacheKey key = {.name_hash = FNV_OFFSET_BASIS, .source_hash = cache->driver_hash};
+    for (int i = 0; i < shader_count; ++i)
+    {
+        key.name_hash = hash_string(key.name_hash, names[i]);
+        key.source_hash = hash_string(key.source_hash, sources[i]);
+    }
+
+    return key;
+}
+
+GLuint program_cache_load(const ProgramCache* const cache, const ProgramCacheKey* const key)
+{
+    if (cache->dir == NULL)
+    {
+        return 0;
+    }
+
+    char* const path = get_cache_path(cache, key);
+    if (path == NULL)
+    {
+        return 0;
+    }
+
+    FILE* const file = fopen(path, "rb");
+    free(path);
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    ProgramCacheHeader header;
+    void* binary = NULL;
+
+    const bool is_read = fread(&header, sizeof(header), 1, file) == 1
+        && header.magic == PROGRAM_CACHE_MAGIC
+        && header.version == PROGRAM_CACHE_VERSION
+        && header.source_hash == key->source_hash
+        && header.length > 0
+        && (binary = malloc(header.length)) != NULL
+        && fread(binary, header.length, 1, file) == 1;
+
+    fclose(file);
+
+    if (!is_read)
+    {
+        free(binary);
+        return 0;
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary, (GLsizei)header.length);
+    free(binary);
+
+    // Drivers may still reject a binary, e.g. one saved before an update that kept the version string
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+void program_cache_prepare(const ProgramCache* const cache, const GLuint program)
+{
+    if (cache->dir != NULL)
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+// Overwrites the binary a previous version of the program left behind
+void program_cache_store(const ProgramCache* const cache, const ProgramCacheKey* const key, const GLuint program)
+{
+    if (cache->dir == NULL)
+    {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    void* const binary = malloc(length);
+    if (binary == NULL)
+    {
+        fputs("Failed to allocate memory for program binary\n", stderr);
+        return;
+    }
+
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary);
+
+    char* const path = get_cache_path(cache, key);
+    FILE* const file = path != NULL ? fopen(path, "wb") : NULL;
+    if (file == NULL)
+    {
+        // Not fatal, the program just gets compiled again next time
+        fprintf(stderr, "Failed to open %s for writing\n", path != NULL ? path : "program cache");
+        free(path);
+        free(binary);
+        return;
+    }
+
+    const ProgramCacheHeader header = {
+        .magic = PROGRAM_CACHE_MAGIC,
+        .version = PROGRAM_CACHE_VERSION,
+        .format = format,
+        .length = (uint32_t)length,
+        .source_hash = key->source_hash
+    };
+
+    bool is_written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(binary, length, 1, file) == 1;
+    if (fclose(file) != 0)
+    {
+        is_written = false;
+    }
+
+    // A partial file would only fail to load, but there is no point keeping it
+    if (!is_written)
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+        remove(path);
+    }
+
+    free(path);
+    free(binary);
+}
+
+// FNV-1a, including the terminator so consecutive strings can't run into each other
+static uint64_t hash_string(uint64_t hash, const char* const string)
+{
+    const size_t length = strlen(string) + 1;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)string[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static char* get_cache_path(const ProgramCache* const cache, const ProgramCacheKey* const key)
+{
+    const char* const format = "%sprogram_%016" PRIx64 ".bin";
+
+    const int path_length = snprintf(NULL, 0, format, cache->dir, key->name_hash);
+    char* const path = malloc(path_length + 1);
+    if (path == NULL)
+    {
+        fputs("Failed to allocate memory for program cache path\n", stderr);
+        return NULL;
+    }
+
+    snprintf(path, path_length + 1, format, cache->dir, key->name_hash);
+
+    return path;
+}
@@ -0,0 +1,144 @@
+#include "test_matrix/resource_pack.h"
+
+#include "test_matrix/file_mapping.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static bool resource_pack_init(ResourcePack* const pack, const unsigned char* const data, const size_t size,
+    const char* const name);
+
+static bool is_range_valid(const ResourcePack* const pack, const uint64_t offset, const uint64_t size);
+
+bool resource_pack_open(ResourcePack* const pack, const char* const path)
+{
+    memset(pack, 0, sizeof(*pack));
+
+    if (!file_mapping_open(&pack->mapping, path))
+    {
+        return false;
+    }
+
+    if (!resource_pack_init(pack, pack->mapping.data, pack->mapping.size, path))
+    {
+        resource_pack_close(pack);
+        return false;
+    }
+
+    return true;
+}
+
+bool resource_pack_open_memory(ResourcePack* const pack, const void* const data, const size_t size,
+    const char* const name)
+{
+    memset(pack, 0, sizeof(*pack));
+
+    if (!resource_pack_init(pack, data, size, name))
+    {
+        resource_pack_close(pack);
+        return false;
+    }
+
+    return true;
+}
+
+void resource_pack_close(ResourcePack* const pack)
+{
+    file_mapping_close(&pack->mapping);
+    memset(pack, 0, sizeof(*pack));
+}
+
+bool resource_pack_find(const ResourcePack* const pack, const char* const name, Resource* const resource)
+{
+    const size_t name_length = strlen(name);
+    const uint64_t name_hash = resource_pack_hash_name(name, name_length);
+    const uint32_t mask = pack->slot_count - 1;
+
+    for (uint32_t i = (uint32_t)name_hash & mask;; i = (i + 1) & mask)
+    {
+        const ResourcePackSlot* const slot = &pack->slots[i];
+        if (slot->name_length == 0)
+        {
+            return false;
+        }
+
+        if (slot->name_hash == name_hash && slot->name_length == name_length
+            && memcmp(pack->names + slot->name_offset, name, name_length) == 0)
+        {
+            resource->data = pack->data + slot->data_offset;
+            resource->size = (size_t)slot->data_size;
+            return true;
+        }
+    }
+}
+
+static bool resource_pack_init(ResourcePack* const pack, const unsigned char* const data, const size_t size,
+    const char* const name)
+{
+    pack->data = data;
+    pack->size = size;
+
+    ResourcePackHeader header;
+    if (pack->size < sizeof(header))
+    {
+        fprintf(stderr, "Resource pack %s is truncated\n", name);
+        return false;
+    }
+    memcpy(&header, pack->data, sizeof(header));
+
+    if (header.magic != RESOURCE_PACK_MAGIC || header.version != RESOURCE_PACK_VERSION)
+    {
+        fprintf(stderr, "%s is not a version %u resource pack\n", name, RESOURCE_PACK_VERSION);
+        return false;
+    }
+
+    const bool is_slot_count_valid = header.slot_count > 0 && (header.slot_count & (header.slot_count - 1)) == 0;
+    if (!is_slot_count_valid || header.slots_offset % sizeof(uint64_t) != 0
+        || !is_range_valid(pack, header.slots_offset, (uint64_t)header.slot_count * sizeof(ResourcePackSlot))
+        || header.names_offset > pack->size)
+    {
+        fprintf(stderr, "Resource pack %s has an invalid index\n", name);
+        return false;
+    }
+
+    pack->slots = (const ResourcePackSlot*)(pack->data + header.slots_offset);
+    pack->slot_count = header.slot_count;
+    pack->names = pack->data + header.names_offset;
+
+    uint32_t empty_slot_count = 0;
+    for (uint32_t i = 0; i < pack->slot_count; ++i)
+    {
+        const ResourcePackSlot* const slot = &pack->slots[i];
+        if (slot->name_length == 0)
+        {
+            ++empty_slot_count;
+            continue;
+        }
+
+        // The zero byte after the data is part of the format
+        if (!is_range_valid(pack, header.names_offset + slot->name_offset, slot->name_length)
+            || slot->data_size >= pack->size || !is_range_valid(pack, slot->data_offset, slot->data_size + 1)
+            || pack->data[slot->data_offset + slot->data_size] != '\0')
+        {
+            fprintf(stderr, "Resource pack %s has an invalid slot\n", name);
+            return false;
+        }
+    }
+
+    // Probing for a missing name only stops at an empty slot
+    if (empty_slot_count == 0)
+    {
+        fprintf(stderr, "Resource pack %s has no empty slot\n", name);
+        return false;
+    }
+
+    return true;
+}
+
+static bool is_range_valid(const ResourcePack* const pack, const uint64_t offset, const uint64_t size)
+{
+    return offset <= pack->size && size <= pack->size - offset;
+}
@@ -0,0 +1,496 @@
+#include "test_matrix/scene.h"
+
+#include "glad/glad.h"
+#include "test_matrix/frustum.h"
+#include "test_matrix/gl_ring_buffer.h"
+#include "test_matrix/mat4f.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool create_gpu_culling_buffers(Scene* const scene);
+
+static void* grow_array(void* const data, int* const capacity, const int required_capacity,
+    const size_t element_size);
+
+int scene_add_mesh(Scene* const scene, const SceneVertex* const vertices, const int vertex_count,
+    const GLuint* const indices, const int index_count)
+{
+    SceneMesh* const new_meshes = grow_array(scene->meshes, &scene->mesh_capacity, scene->mesh_count + 1,
+        sizeof(SceneMesh));
+    if (new_meshes == NULL)
+    {
+        fputs("Failed to allocate memory for scene meshes\n", stderr);
+        return -1;
+    }
+    scene->meshes = new_meshes;
+
+    float radius_squared = 0.0f;
+    for (int i = 0; i < vertex_count; ++i)
+    {
+        const float* const position = vertices[i].position;
+        const float distance_squared =
+            position[0] * position[0] + position[1] * position[1] + position[2] * position[2];
+        if (distance_squared > radius_squared)
+        {
+            radius_squared = distance_squared;
+        }
+    }
+
+    // Indices stay relative to the mesh, base_vertex offsets them into the shared vertex buffer
+    scene->meshes[scene->mesh_count] = (SceneMesh){
+        .first_index = (GLuint)scene->index_count,
+        .index_count = (GLuint)index_count,
+        .base_vertex = scene->vertex_count,
+        .radius = sqrtf(radius_squared),
+        .vertices = vertices,
+        .vertex_count = vertex_count,
+        .indices = indices
+    };
+
+    scene->vertex_count += vertex_count;
+    scene->index_count += index_count;
+
+    return scene->mesh_count++;
+}
+
+bool scene_add_object(Scene* const scene, const int mesh, const Mat4f* const model)
+{
+    SceneObject* const new_objects = grow_array(scene->objects, &scene->object_capacity, scene->object_count + 1,
+        sizeof(SceneObject));
+    if (new_objects == NULL)
+    {
+        fputs("Failed to allocate memory for scene objects\n", stderr);
+        return false;
+    }
+    scene->objects = new_objects;
+
+    scene->objects[scene->object_count] = (SceneObject){.model = *model, .mesh = mesh};
+    ++scene->object_count;
+
+    return true;
+}
+
+bool scene_upload(Scene* const scene, const bool use_gpu_culling)
+{
+    const size_t object_capacity = scene->object_count > 0 ? scene->object_count : 1;
+
+    scene->instance_models = malloc(object_capacity * sizeof(Mat4f));
+    scene->bounds_x = malloc(object_capacity * sizeof(float));
+    scene->bounds_y = malloc(object_capacity * sizeof(float));
+    scene->bounds_z = malloc(object_capacity * sizeof(float));
+    scene->bounds_radius = malloc(object_capacity * sizeof(float));
+    scene->visible_instances = malloc(object_capacity * sizeof(uint32_t));
+    scene->commands = calloc(scene->mesh_count > 0 ? scene->mesh_count : 1, sizeof(DrawElementsIndirectCommand));
+    if (scene->instance_models == NULL || scene->bounds_x == NULL || scene->bounds_y == NULL
+        || scene->bounds_z == NULL || scene->bounds_radius == NULL || scene->visible_instances == NULL
+        || scene->commands == NULL)
+    {
+        fputs("Failed to allocate memory for scene draw data\n", stderr);
+        return false;
+    }
+
+    // Counting sort of the objects by mesh: count, then turn the counts into base instances
+    for (int i = 0; i < scene->object_count; ++i)
+    {
+        ++scene->commands[scene->objects[i].mesh].instance_count;
+    }
+
+    GLuint base_instance = 0;
+    for (int i = 0; i < scene->mesh_count; ++i)
+    {
+        DrawElementsIndirectCommand* const command = &scene->commands[i];
+        command->count = scene->meshes[i].index_count;
+        command->first_index = scene->meshes[i].first_index;
+        command->base_vertex = scene->meshes[i].base_vertex;
+        command->base_instance = base_instance;
+
+        base_instance += command->instance_count;
+        command->instance_count = 0;
+    }
+
+    for (int i = 0; i < scene->object_count; ++i)
+    {
+        const SceneObject* const object = &scene->objects[i];
+        const float (*const m)[4] = object->model.value;
+
+        DrawElementsIndirectCommand* const command = &scene->commands[object->mesh];
+        const GLuint instance = command->base_instance + command->instance_count;
+        ++command->instance_count;
+
+        // GLSL reads each attribute location of a mat4 as one column
+        scene->instance_models[instance] = mat4f_transpose(&object->model);
+
+        // The mesh's sphere moves with the translation and grows with the largest axis scale
+        float scale_squared = 0.0f;
+        for (int j = 0; j < 3; ++j)
+        {
+            const float axis_squared = m[0][j] * m[0][j] + m[1][j] * m[1][j] + m[2][j] * m[2][j];
+            if (axis_squared > scale_squared)
+            {
+                scale_squared = axis_squared;
+            }
+        }
+
+        scene->bounds_x[instance] = m[0][3];
+        scene->bounds_y[instance] = m[1][3];
+        scene->bounds_z[instance] = m[2][3];
+        scene->bounds_radius[instance] = scene->meshes[object->mesh].radius * sqrtf(scale_squared);
+    }
+
+    // A single mesh is the whole buffer; otherwise each one is copied from its source into its range
+    const bool has_one_mesh = scene->mesh_count == 1;
+    const GLbitfield storage_flags = has_one_mesh ? 0 : GL_DYNAMIC_STORAGE_BIT;
+
+    glGenBuffers(1, &scene->vertex_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, scene->vertex_buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, scene->vertex_count * sizeof(SceneVertex),
+        has_one_mesh ? scene->meshes[0].vertices : NULL, storage_flags);
+
+    glGenVertexArrays(1, &scene->vao);
+    glBindVertexArray(scene->vao);
+
+    glGenBuffers(1, &scene->index_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene->index_buffer);
+    glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, scene->index_count * sizeof(GLuint),
+        has_one_mesh ? scene->meshes[0].indices : NULL, storage_flags);
+
+    if (!has_one_mesh)
+    {
+        for (int i = 0; i < scene->mesh_count; ++i)
+        {
+            const SceneMesh* const mesh = &scene->meshes[i];
+            glBufferSubData(GL_ARRAY_BUFFER, mesh->base_vertex * sizeof(SceneVertex),
+                mesh->vertex_count * sizeof(SceneVertex), mesh->vertices);
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, mesh->first_index * sizeof(GLuint),
+                mesh->index_count * sizeof(GLuint), mesh->indices);
+        }
+    }
+
+    glBindVertexBuffer(SCENE_VERTEX_BUFFER_BINDING, scene->vertex_buffer, 0, sizeof(SceneVertex));
+
+    glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(SceneVertex, position));
+    glVertexAttribBinding(0, SCENE_VERTEX_BUFFER_BINDING);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, offsetof(SceneVertex, color));
+    glVertexAttribBinding(1, SCENE_VERTEX_BUFFER_BINDING);
+    glEnableVertexAttribArray(1);
+
+    if (use_gpu_culling)
+    {
+        if (!create_gpu_culling_buffers(scene))
+        {
+            glBindVertexArray(0);
+            return false;
+        }
+
+        // Each instance fetches its object's index from the visible list, starting at the command's
+        // base_instance, and the vertex shader looks the model up with it
+        glVertexAttribIFormat(2, 1, GL_UNSIGNED_INT, 0);
+        glVertexAttribBinding(2, SCENE_INSTANCE_BUFFER_BINDING);
+        glEnableVertexAttribArray(2);
+
+        glBindVertexBuffer(SCENE_INSTANCE_BUFFER_BINDING, scene->visible_instance_buffer, 0, sizeof(GLuint));
+    }
+    else
+    {
+        // The instance buffer itself is bound per frame at that frame's ring buffer offset
+        for (int i = 0; i < 4; ++i)
+        {
+            glVertexAttribFormat(2 + i, 4, GL_FLOAT, GL_FALSE, i * 4 * sizeof(float));
+            glVertexAttribBinding(2 + i, SCENE_INSTANCE_BUFFER_BINDING);
+            glEnableVertexAttribArray(2 + i);
+        }
+    }
+    glVertexBindingDivisor(SCENE_INSTANCE_BUFFER_BINDING, 1);
+
+    glBindVertexArray(0);
+
+    return true;
+}
+
+GLsizeiptr scene_get_frame_stream_size(const Scene* const scene)
+{
+    if (scene->is_gpu_culled)
+    {
+        return 0;
+    }
+
+    return scene->object_count * sizeof(Mat4f) + scene->mesh_count * sizeof(DrawElementsIndirectCommand);
+}
+
+bool scene_draw(Scene* const scene, GlRingBuffer* const ring, const Frustum* const frustum,
+    int* const visible_count)
+{
+    *visible_count = (int)frustum_cull_spheres(frustum, scene->bounds_x, scene->bounds_y, scene->bounds_z,
+        scene->bounds_radius, scene->object_count, scene->visible_instances);
+    if (*visible_count == 0)
+    {
+        return true;
+    }
+
+    GLintptr instances_offset;
+    Mat4f* const instances = gl_ring_buffer_allocate(ring, *visible_count * sizeof(Mat4f), &instances_offset);
+    if (instances == NULL)
+    {
+        return false;
+    }
+
+    GLintptr commands_offset;
+    DrawElementsIndirectCommand* const commands = gl_ring_buffer_allocate(ring,
+        scene->mesh_count * sizeof(DrawElementsIndirectCommand), &commands_offset);
+    if (commands == NULL)
+    {
+        return false;
+    }
+
+    // Visible instances come out of culling in ascending order, so each mesh's survivors are one run
+    int visible = 0;
+    for (int i = 0; i < scene->mesh_count; ++i)
+    {
+        const DrawElementsIndirectCommand* const all = &scene->commands[i];
+        const GLuint instance_end = all->base_instance + all->instance_count;
+
+        commands[i] = *all;
+        commands[i].base_instance = (GLuint)visible;
+
+        while (visible < *visible_count && scene->visible_instances[visible] < instance_end)
+        {
+            instances[visible] = scene->instance_models[scene->visible_instances[visible]];
+            ++visible;
+        }
+
+        commands[i].instance_count = (GLuint)visible - commands[i].base_instance;
+    }
+
+    glBindVertexArray(scene->vao);
+    glBindVertexBuffer(SCENE_INSTANCE_BUFFER_BINDING, ring->buffer, instances_offset, sizeof(Mat4f));
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, ring->buffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)commands_offset, scene->mesh_count, 0);
+
+    return true;
+}
+
+void scene_cull_gpu(Scene* const scene, const GLuint cull_program, const GlRingBuffer* const ring,
+    const Frustum* const frustum, int* const visible_count)
+{
+    const GLsizeiptr commands_size = scene->mesh_count * sizeof(DrawElementsIndirectCommand);
+
+    // The ring buffer waited for this region's fence, so the copy made the last time it was used is done
+    const DrawElementsIndirectCommand* const readback = &scene->readback_mapping[ring->region * scene->mesh_count];
+    int visible = 0;
+    for (int i = 0; i < scene->mesh_count; ++i)
+    {
+        visible += (int)readback[i].instance_count;
+    }
+    *visible_count = visible;
+
+    // Only the instance counts change from frame to frame
+    const GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, scene->command_buffer);
+    for (int i = 0; i < scene->mesh_count; ++i)
+    {
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI,
+            i * sizeof(DrawElementsIndirectCommand) + offsetof(DrawElementsIndirectCommand, instance_count),
+            sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SCENE_BOUNDS_STORAGE_BINDING, scene->bounds_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SCENE_INSTANCE_MESH_STORAGE_BINDING, scene->instance_mesh_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SCENE_COMMAND_STORAGE_BINDING, scene->command_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SCENE_VISIBLE_INSTANCE_STORAGE_BINDING,
+        scene->visible_instance_buffer);
+
+    glUseProgram(cull_program);
+    glUniform4fv(SCENE_CULL_PLANES_LOCATION, FRUSTUM_PLANE_COUNT, &frustum->planes[0][0]);
+    glUniform1ui(SCENE_CULL_OBJECT_COUNT_LOCATION, (GLuint)scene->object_count);
+    glDispatchCompute((scene->object_count + SCENE_CULL_GROUP_SIZE - 1) / SCENE_CULL_GROUP_SIZE, 1, 1);
+
+    // The draw reads the commands and the visible list as indirect and vertex data, the readback copies them
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, scene->command_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, scene->readback_buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, ring->region * commands_size,
+        commands_size);
+}
+
+void scene_draw_gpu_culled(const Scene* const scene)
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SCENE_MODEL_STORAGE_BINDING, scene->model_buffer);
+
+    glBindVertexArray(scene->vao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, scene->command_buffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, NULL, scene->mesh_count, 0);
+}
+
+void scene_destroy(Scene* const scene)
+{
+    if (scene->readback_buffer != 0)
+    {
+        if (scene->readback_mapping != NULL)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, scene->readback_buffer);
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+        }
+
+        glDeleteBuffers(1, &scene->readback_buffer);
+    }
+
+    const GLuint gpu_culling_buffers[] = {
+        scene->bounds_buffer,
+        scene->instance_mesh_buffer,
+        scene->model_buffer,
+        scene->command_buffer,
+        scene->visible_instance_buffer
+    };
+    for (size_t i = 0; i < sizeof(gpu_culling_buffers) / sizeof(gpu_culling_buffers[0]); ++i)
+    {
+        if (gpu_culling_buffers[i] != 0)
+        {
+            glDeleteBuffers(1, &gpu_culling_buffers[i]);
+        }
+    }
+
+    if (scene->vao != 0)
+    {
+        glDeleteVertexArrays(1, &scene->vao);
+    }
+
+    if (scene->index_buffer != 0)
+    {
+        glDeleteBuffers(1, &scene->index_buffer);
+    }
+
+    if (scene->vertex_buffer != 0)
+    {
+        glDeleteBuffers(1, &scene->vertex_buffer);
+    }
+
+    free(scene->visible_instances);
+    free(scene->commands);
+    free(scene->bounds_radius);
+    free(scene->bounds_z);
+    free(scene->bounds_y);
+    free(scene->bounds_x);
+    free(scene->instance_models);
+    free(scene->objects);
+    free(scene->meshes);
+
+    memset(scene, 0, sizeof(*scene));
+}
+
+static bool create_gpu_culling_buffers(Scene* const scene)
+{
+    const size_t object_capacity = scene->object_count > 0 ? scene->object_count : 1;
+    const GLsizeiptr commands_size = scene->mesh_count * sizeof(DrawElementsIndirectCommand);
+
+    float (*const bounds)[4] = malloc(object_capacity * sizeof(*bounds));
+    GLuint* const instance_meshes = malloc(object_capacity * sizeof(GLuint));
+    if (bounds == NULL || instance_meshes == NULL)
+    {
+        free(instance_meshes);
+        free(bounds);
+        fputs("Failed to allocate memory for scene culling data\n", stderr);
+        return false;
+    }
+
+    for (int i = 0; i < scene->object_count; ++i)
+    {
+        bounds[i][0] = scene->bounds_x[i];
+        bounds[i][1] = scene->bounds_y[i];
+        bounds[i][2] = scene->bounds_z[i];
+        bounds[i][3] = scene->bounds_radius[i];
+    }
+
+    for (int i = 0; i < scene->mesh_count; ++i)
+    {
+        const DrawElementsIndirectCommand* const command = &scene->commands[i];
+        for (GLuint j = 0; j < command->instance_count; ++j)
+        {
+            instance_meshes[command->base_instance + j] = (GLuint)i;
+        }
+    }
+
+    glGenBuffers(1, &scene->bounds_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, scene->bounds_buffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, object_capacity * sizeof(*bounds), bounds, 0);
+
+    glGenBuffers(1, &scene->instance_mesh_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, scene->instance_mesh_buffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, object_capacity * sizeof(GLuint), instance_meshes, 0);
+
+    free(instance_meshes);
+    free(bounds);
+
+    glGenBuffers(1, &scene->model_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, scene->model_buffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, object_capacity * sizeof(Mat4f), scene->instance_models, 0);
+
+    // Each mesh's instances land in the range its command covers when nothing is culled
+    glGenBuffers(1, &scene->command_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, scene->command_buffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, commands_size, scene->commands, 0);
+
+    glGenBuffers(1, &scene->visible_instance_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, scene->visible_instance_buffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, object_capacity * sizeof(GLuint), NULL, 0);
+
+    // Zeroed, so the first frames through each region read back nothing visible
+    void* const zeroes = calloc(GL_RING_BUFFER_REGION_COUNT, commands_size);
+    if (zeroes == NULL)
+    {
+        fputs("Failed to allocate memory for scene culling data\n", stderr);
+        return false;
+    }
+
+    const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &scene->readback_buffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, scene->readback_buffer);
+    glBufferStorage(GL_COPY_READ_BUFFER, GL_RING_BUFFER_REGION_COUNT * commands_size, zeroes,
+        flags | GL_CLIENT_STORAGE_BIT);
+    free(zeroes);
+
+    scene->readback_mapping = glMapBufferRange(GL_COPY_READ_BUFFER, 0, GL_RING_BUFFER_REGION_COUNT * commands_size,
+        flags);
+    if (scene->readback_mapping == NULL)
+    {
+        fputs("Failed to map scene readback buffer\n", stderr);
+        return false;
+    }
+
+    scene->is_gpu_culled = true;
+
+    return true;
+}
+
+static void* grow_array(void* const data, int* const capacity, const int required_capacity,
+    const size_t element_size)
+{
+    if (required_capacity <= *capacity)
+    {
+        return data;
+    }
+
+    int new_capacity = *capacity > 0 ? *capacity : 16;
+    while (new_capacity < required_capacity)
+    {
+        new_capacity *= 2;
+    }
+
+    void* const new_data = realloc(data, new_capacity * element_size);
+    if (new_data != NULL)
+    {
+        *capacity = new_capacity;
+    }
+
+    return new_data;
+}
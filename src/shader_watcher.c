@@ -0,0 +1,115 @@
+#include "test_matrix/shader_watcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+
+static bool is_shader_file(const char* const name);
+
+bool shader_watcher_create(ShaderWatcher* const watcher, const char* const dir)
+{
+    watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher->fd < 0)
+    {
+        fputs("Failed to initialize inotify\n", stderr);
+        return false;
+    }
+
+    // Editors either rewrite a file in place or write a temporary one and rename it over the original
+    if (inotify_add_watch(watcher->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        fprintf(stderr, "Failed to watch %s\n", dir);
+        shader_watcher_destroy(watcher);
+        return false;
+    }
+
+    return true;
+}
+
+void shader_watcher_destroy(ShaderWatcher* const watcher)
+{
+    if (watcher->fd >= 0)
+    {
+        close(watcher->fd);
+    }
+
+    watcher->fd = -1;
+}
+
+bool shader_watcher_poll(ShaderWatcher* const watcher)
+{
+    if (watcher->fd < 0)
+    {
+        return false;
+    }
+
+    // Saving one file can raise several events, so a single reload covers all of them
+    bool is_changed = false;
+
+    alignas(struct inotify_event) char events[4096];
+    ssize_t length = read(watcher->fd, events, sizeof(events));
+    while (length > 0)
+    {
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const struct inotify_event* const event = (const struct inotify_event*)(events + offset);
+            is_changed |= event->len > 0 && is_shader_file(event->name);
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+
+        length = read(watcher->fd, events, sizeof(events));
+    }
+
+    return is_changed;
+}
+
+// Editors also write swap, backup and probe files such as .shader.frag.swp, shader.frag~ and 4913 next to
+// the file being saved, which must not trigger a reload
+static bool is_shader_file(const char* const name)
+{
+    static const char* const extensions[] = {".vert", ".frag", ".comp"};
+
+    const size_t name_length = strlen(name);
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); ++i)
+    {
+        const size_t extension_length = strlen(extensions[i]);
+        if (name_length > extension_length
+            && strcmp(name + name_length - extension_length, extensions[i]) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#else
+
+bool shader_watcher_create(ShaderWatcher* const watcher, const char* const dir)
+{
+    (void)dir;
+    watcher->fd = -1;
+    return true;
+}
+
+void shader_watcher_destroy(ShaderWatcher* const watcher)
+{
+    watcher->fd = -1;
+}
+
+bool shader_watcher_poll(ShaderWatcher* const watcher)
+{
+    (void)watcher;
+    return false;
+}
+
+#endif
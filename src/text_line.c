@@ -0,0 +1,61 @@
+#include "test_matrix/text_line.h"
+
+#include "test_matrix/glyph_atlas.h"
+
+#include <SDL_pixels.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+void text_line_key_init(TextLineKey* const key, const float* const values, const int value_count,
+    const SDL_Color color, const int x, const int y)
+{
+    assert(value_count >= 0 && value_count <= TEXT_LINE_MAX_VALUES);
+    const int clamped_count = value_count < 0 ? 0
+        : value_count > TEXT_LINE_MAX_VALUES ? TEXT_LINE_MAX_VALUES : value_count;
+
+    // Keys are compared bytewise, so padding and unused values must be zero, and -0.0f must become 0.0f
+    memset(key, 0, sizeof(*key));
+    for (int i = 0; i < clamped_count; ++i)
+    {
+        key->values[i] = values[i] == 0.0f ? 0.0f : values[i];
+    }
+    key->value_count = clamped_count;
+    key->color = color;
+    key->x = x;
+    key->y = y;
+}
+
+bool text_line_is_dirty(const TextLine* const line, const TextLineKey* const key)
+{
+    return !line->is_valid || memcmp(&line->key, key, sizeof(*key)) != 0;
+}
+
+bool text_line_update(TextLine* const line, const GlyphAtlas* const atlas,
+    const TextLineKey* const key, const char* const text)
+{
+    line->is_valid = false;
+    text_geometry_clear(&line->geometry);
+
+    if (!glyph_atlas_append_text(atlas, &line->geometry, text, key->color, key->x, key->y))
+    {
+        return false;
+    }
+
+    line->key = *key;
+    line->is_valid = true;
+
+    return true;
+}
+
+bool text_line_append(const TextLine* const line, TextGeometry* const geometry)
+{
+    return text_geometry_append(geometry, &line->geometry);
+}
+
+void text_line_destroy(TextLine* const line)
+{
+    text_geometry_destroy(&line->geometry);
+    line->is_valid = false;
+}
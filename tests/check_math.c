@@ -0,0 +1,323 @@
+#include "test_matrix/cpu_features.h"
+#include "test_matrix/frustum.h"
+#include "test_matrix/mat4f.h"
+#include "test_matrix/vec3f.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK_ROUND_COUNT 1000
+
+// Batches of every size up to this, so each kernel's tail handling gets checked for every remainder
+#define CHECK_POINT_CAPACITY 67
+
+// Written just past the end of every output, where no kernel may write
+#define CHECK_GUARD_VALUE 12345.0f
+
+static float random_float(const float min, const float max);
+
+static Mat4f random_mat4f(void);
+
+static bool is_close(const float actual, const float expected);
+
+static bool check_mat4f_product(const char* const name, const Mat4fProductFn kernel);
+
+static bool check_mat4f_transform_points(const char* const name, const Mat4fTransformPointsFn kernel);
+
+static bool check_mat4f_transform_points_soa(const char* const name, const Mat4fTransformPointsSoaFn kernel);
+
+static void random_frustum(Frustum* const frustum);
+
+static void random_sphere(const Frustum* const frustum, float* const x, float* const y, float* const z,
+    float* const radius);
+
+static bool check_frustum_cull_spheres(const char* const name, const FrustumCullSpheresFn kernel);
+
+// Checks the dispatched functions and every SIMD kernel against the scalar ones on random inputs
+int main(void)
+{
+    srand(42);
+
+    printf("mat4f_product dispatches to %s\n", mat4f_product_kernel_name());
+    printf("mat4f_transform_points dispatches to %s\n", mat4f_transform_points_kernel_name());
+    printf("mat4f_transform_points_soa dispatches to %s\n", mat4f_transform_points_soa_kernel_name());
+    printf("frustum_cull_spheres dispatches to %s\n", frustum_cull_spheres_kernel_name());
+
+    bool success = check_mat4f_product("mat4f_product", mat4f_product);
+    success &= check_mat4f_transform_points("mat4f_transform_points", mat4f_transform_points);
+    success &= check_mat4f_transform_points_soa("mat4f_transform_points_soa", mat4f_transform_points_soa);
+    success &= check_frustum_cull_spheres("frustum_cull_spheres", frustum_cull_spheres);
+
+#if CPU_FEATURES_SSE2
+    success &= check_mat4f_product("mat4f_product_sse", mat4f_product_sse);
+    success &= check_mat4f_transform_points("mat4f_transform_points_sse", mat4f_transform_points_sse);
+    success &= check_mat4f_transform_points_soa("mat4f_transform_points_soa_sse", mat4f_transform_points_soa_sse);
+    success &= check_frustum_cull_spheres("frustum_cull_spheres_sse", frustum_cull_spheres_sse);
+
+    const CpuFeatures* const features = cpu_features_get();
+    if (features->avx2 && features->fma)
+    {
+        success &= check_mat4f_product("mat4f_product_avx2", mat4f_product_avx2);
+        success &= check_mat4f_transform_points_soa("mat4f_transform_points_soa_avx2",
+            mat4f_transform_points_soa_avx2);
+        success &= check_frustum_cull_spheres("frustum_cull_spheres_avx2", frustum_cull_spheres_avx2);
+    }
+    else
+    {
+        puts("skipped AVX2 kernels, the CPU doesn't support them");
+    }
+#endif
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static float random_float(const float min, const float max)
+{
+    return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+static Mat4f random_mat4f(void)
+{
+    Mat4f mat;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            mat.value[i][j] = random_float(-4.0f, 4.0f);
+        }
+    }
+
+    return mat;
+}
+
+// FMA kernels round differently from the scalar ones, so results only have to agree closely
+static bool is_close(const float actual, const float expected)
+{
+    return fabsf(actual - expected) <= 1e-4f * (1.0f + fabsf(expected));
+}
+
+static bool check_mat4f_product(const char* const name, const Mat4fProductFn kernel)
+{
+    for (int round = 0; round < CHECK_ROUND_COUNT; ++round)
+    {
+        const Mat4f mat1 = random_mat4f();
+        const Mat4f mat2 = random_mat4f();
+
+        const Mat4f expected = mat4f_product_scalar(&mat1, &mat2);
+        const Mat4f actual = kernel(&mat1, &mat2);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                if (!is_close(actual.value[i][j], expected.value[i][j]))
+                {
+                    fprintf(stderr, "%s: element [%d][%d] is %f instead of %f\n", name, i, j,
+                        actual.value[i][j], expected.value[i][j]);
+                    return false;
+                }
+            }
+        }
+    }
+
+    printf("%s: ok\n", name);
+    return true;
+}
+
+static bool check_mat4f_transform_points(const char* const name, const Mat4fTransformPointsFn kernel)
+{
+    Vec3f in[CHECK_POINT_CAPACITY];
+    Vec3f expected[CHECK_POINT_CAPACITY];
+    Vec3f actual[CHECK_POINT_CAPACITY + 1];
+
+    for (int round = 0; round < CHECK_ROUND_COUNT; ++round)
+    {
+        const Mat4f mat = random_mat4f();
+        const size_t count = (size_t)round % (CHECK_POINT_CAPACITY + 1);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                in[i].value[j] = random_float(-10.0f, 10.0f);
+            }
+        }
+
+        actual[count] = (Vec3f){{CHECK_GUARD_VALUE, CHECK_GUARD_VALUE, CHECK_GUARD_VALUE}};
+
+        mat4f_transform_points_scalar(&mat, in, expected, count);
+        kernel(&mat, in, actual, count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                if (!is_close(actual[i].value[j], expected[i].value[j]))
+                {
+                    fprintf(stderr, "%s: point %zu of %zu, component %d is %f instead of %f\n", name, i, count, j,
+                        actual[i].value[j], expected[i].value[j]);
+                    return false;
+                }
+            }
+        }
+
+        if (actual[count].value[0] != CHECK_GUARD_VALUE || actual[count].value[1] != CHECK_GUARD_VALUE
+            || actual[count].value[2] != CHECK_GUARD_VALUE)
+        {
+            fprintf(stderr, "%s: wrote past the end of %zu points\n", name, count);
+            return false;
+        }
+    }
+
+    printf("%s: ok\n", name);
+    return true;
+}
+
+static bool check_mat4f_transform_points_soa(const char* const name, const Mat4fTransformPointsSoaFn kernel)
+{
+    float in[3][CHECK_POINT_CAPACITY];
+    float expected[3][CHECK_POINT_CAPACITY];
+    float actual[3][CHECK_POINT_CAPACITY + 1];
+
+    for (int round = 0; round < CHECK_ROUND_COUNT; ++round)
+    {
+        const Mat4f mat = random_mat4f();
+        const size_t count = (size_t)round % (CHECK_POINT_CAPACITY + 1);
+
+        for (int j = 0; j < 3; ++j)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                in[j][i] = random_float(-10.0f, 10.0f);
+            }
+
+            actual[j][count] = CHECK_GUARD_VALUE;
+        }
+
+        mat4f_transform_points_soa_scalar(&mat, in[0], in[1], in[2], expected[0], expected[1], expected[2], count);
+        kernel(&mat, in[0], in[1], in[2], actual[0], actual[1], actual[2], count);
+
+        for (int j = 0; j < 3; ++j)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!is_close(actual[j][i], expected[j][i]))
+                {
+                    fprintf(stderr, "%s: point %zu of %zu, component %d is %f instead of %f\n", name, i, count, j,
+                        actual[j][i], expected[j][i]);
+                    return false;
+                }
+            }
+
+            if (actual[j][count] != CHECK_GUARD_VALUE)
+            {
+                fprintf(stderr, "%s: wrote past the end of %zu points\n", name, count);
+                return false;
+            }
+        }
+    }
+
+    printf("%s: ok\n", name);
+    return true;
+}
+
+// A camera at the origin looking in a random direction, with a finite far plane so all six planes cull
+static void random_frustum(Frustum* const frustum)
+{
+    const Vec3f world_up = {{0.0f, 1.0f, 0.0f}};
+    const Vec3f pos = {{0.0f, 0.0f, 0.0f}};
+
+    Vec3f dir = {{random_float(-1.0f, 1.0f), random_float(-0.5f, 0.5f), random_float(-1.0f, 1.0f)}};
+    dir.value[2] += dir.value[2] >= 0.0f ? 0.1f : -0.1f;
+    dir = vec3f_normalize(&dir);
+
+    Vec3f right = vec3f_cross(&dir, &world_up);
+    right = vec3f_normalize(&right);
+    const Vec3f up = vec3f_cross(&right, &dir);
+
+    const Mat4f view = mat4f_look_at(&right, &up, &dir, &pos);
+    const Mat4f projection = mat4f_perspective_reverse_z(random_float(0.5f, 2.0f), random_float(0.5f, 2.0f),
+        0.1f, random_float(5.0f, 20.0f));
+    const Mat4f view_projection = mat4f_product(&projection, &view);
+    frustum_from_matrix(frustum, &view_projection);
+}
+
+// Spheres that nearly touch a plane are redrawn, since rounding may legitimately put them on either side
+static void random_sphere(const Frustum* const frustum, float* const x, float* const y, float* const z,
+    float* const radius)
+{
+    bool is_near_plane = true;
+    while (is_near_plane)
+    {
+        *x = random_float(-20.0f, 20.0f);
+        *y = random_float(-20.0f, 20.0f);
+        *z = random_float(-20.0f, 20.0f);
+        *radius = random_float(0.0f, 2.0f);
+
+        is_near_plane = false;
+        for (int i = 0; i < FRUSTUM_PLANE_COUNT; ++i)
+        {
+            const float* const plane = frustum->planes[i];
+            const double distance = (double)plane[0] * *x + (double)plane[1] * *y + (double)plane[2] * *z
+                + (double)plane[3];
+            is_near_plane |= fabs(distance + *radius) < 1e-3;
+        }
+    }
+}
+
+static bool check_frustum_cull_spheres(const char* const name, const FrustumCullSpheresFn kernel)
+{
+    float x[CHECK_POINT_CAPACITY];
+    float y[CHECK_POINT_CAPACITY];
+    float z[CHECK_POINT_CAPACITY];
+    float radius[CHECK_POINT_CAPACITY];
+    uint32_t expected[CHECK_POINT_CAPACITY];
+    uint32_t actual[CHECK_POINT_CAPACITY + 1];
+
+    for (int round = 0; round < CHECK_ROUND_COUNT; ++round)
+    {
+        Frustum frustum;
+        random_frustum(&frustum);
+
+        const size_t count = (size_t)round % (CHECK_POINT_CAPACITY + 1);
+        for (size_t i = 0; i < count; ++i)
+        {
+            random_sphere(&frustum, &x[i], &y[i], &z[i], &radius[i]);
+        }
+
+        actual[count] = UINT32_MAX;
+
+        const size_t expected_count = frustum_cull_spheres_scalar(&frustum, x, y, z, radius, count, expected);
+        const size_t actual_count = kernel(&frustum, x, y, z, radius, count, actual);
+
+        if (actual_count != expected_count)
+        {
+            fprintf(stderr, "%s: %zu of %zu spheres are visible instead of %zu\n", name, actual_count, count,
+                expected_count);
+            return false;
+        }
+
+        for (size_t i = 0; i < expected_count; ++i)
+        {
+            if (actual[i] != expected[i])
+            {
+                fprintf(stderr, "%s: visible sphere %zu of %zu is %u instead of %u\n", name, i, count,
+                    (unsigned)actual[i], (unsigned)expected[i]);
+                return false;
+            }
+        }
+
+        if (actual[count] != UINT32_MAX)
+        {
+            fprintf(stderr, "%s: wrote past the end of %zu spheres\n", name, count);
+            return false;
+        }
+    }
+
+    printf("%s: ok\n", name);
+    return true;
+}
@@ -0,0 +1,82 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Enough for a resource pack, which relies on its base being aligned like the data inside it
+#define EMBED_ALIGNMENT 64
+
+static bool write_source(FILE* const input, FILE* const output, const char* const symbol);
+
+int main(int argc, char* argv[])
+{
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s INPUT OUTPUT.c SYMBOL\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* const input = fopen(argv[1], "rb");
+    if (input == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FILE* const output = fopen(argv[2], "w");
+    if (output == NULL)
+    {
+        fprintf(stderr, "Failed to open %s for writing\n", argv[2]);
+        fclose(input);
+        return EXIT_FAILURE;
+    }
+
+    bool success = write_source(input, output, argv[3]);
+
+    if (ferror(input))
+    {
+        fprintf(stderr, "Failed to read %s\n", argv[1]);
+        success = false;
+    }
+    fclose(input);
+
+    if (fclose(output) != 0)
+    {
+        success = false;
+    }
+
+    if (!success)
+    {
+        fprintf(stderr, "Failed to write %s\n", argv[2]);
+        remove(argv[2]);
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// The array gets a trailing zero byte so that even an empty input is a valid initializer; the size
+// constant doesn't count it
+static bool write_source(FILE* const input, FILE* const output, const char* const symbol)
+{
+    if (fprintf(output, "#include <stdalign.h>\n#include <stddef.h>\n\n") < 0
+        || fprintf(output, "alignas(%d) const unsigned char %s[] = {\n", EMBED_ALIGNMENT, symbol) < 0)
+    {
+        return false;
+    }
+
+    size_t size = 0;
+    for (int byte = fgetc(input); byte != EOF; byte = fgetc(input))
+    {
+        const char* const separator = size % 16 == 0 ? "    " : " ";
+        const char* const terminator = size % 16 == 15 ? ",\n" : ",";
+        if (fprintf(output, "%s0x%02X%s", separator, (unsigned)byte, terminator) < 0)
+        {
+            return false;
+        }
+
+        ++size;
+    }
+
+    const char* const separator = size % 16 == 0 ? "    " : " ";
+    return fprintf(output, "%s0x00\n};\n\nconst size_t %s_size = %zu;\n", separator, symbol, size) >= 0;
+}
@@ -0,0 +1,323 @@
+#include "test_matrix/mesh_file.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_CAPACITY 4096
+
+// Most vertices a single face may have before it is fan triangulated
+#define FACE_VERTEX_CAPACITY 64
+
+typedef struct Mesh
+{
+    MeshFileVertex* vertices;
+    uint32_t vertex_count;
+    uint32_t vertex_capacity;
+    bool has_vertex_colors;
+
+    uint32_t* indices;
+    uint32_t index_count;
+    uint32_t index_capacity;
+} Mesh;
+
+static bool read_obj(Mesh* const mesh, const char* const path);
+
+static bool parse_face(Mesh* const mesh, const char* const path, const char* text, const int line_number);
+
+static void fill_vertex_colors(Mesh* const mesh);
+
+static bool write_mesh(const Mesh* const mesh, const char* const path);
+
+static bool write_padding(FILE* const file, const uint64_t offset);
+
+static void* grow_array(void* const data, uint32_t* const capacity, const uint32_t required_capacity,
+    const size_t element_size);
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s INPUT.obj OUTPUT.mesh\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Mesh mesh = {0};
+
+    const bool success = read_obj(&mesh, argv[1]) && write_mesh(&mesh, argv[2]);
+
+    free(mesh.indices);
+    free(mesh.vertices);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Reads positions, the optional "v x y z r g b" vertex colors and faces; texture coordinates, normals
+// and everything else are skipped
+static bool read_obj(Mesh* const mesh, const char* const path)
+{
+    FILE* const file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    bool success = true;
+    bool has_colorless_vertex = false;
+
+    char line[LINE_CAPACITY];
+    for (int line_number = 1; success && fgets(line, sizeof(line), file) != NULL; ++line_number)
+    {
+        if (line[0] == 'v' && isspace((unsigned char)line[1]))
+        {
+            MeshFileVertex* const vertices = grow_array(mesh->vertices, &mesh->vertex_capacity,
+                mesh->vertex_count + 1, sizeof(MeshFileVertex));
+            if (vertices == NULL)
+            {
+                fputs("Failed to allocate memory for vertices\n", stderr);
+                success = false;
+                break;
+            }
+            mesh->vertices = vertices;
+
+            MeshFileVertex* const vertex = &mesh->vertices[mesh->vertex_count];
+            const int value_count = sscanf(line + 2, "%f %f %f %f %f %f",
+                &vertex->position[0], &vertex->position[1], &vertex->position[2],
+                &vertex->color[0], &vertex->color[1], &vertex->color[2]);
+            if (value_count == 6)
+            {
+                mesh->has_vertex_colors = true;
+            }
+            else if (value_count == 3)
+            {
+                has_colorless_vertex = true;
+            }
+            else
+            {
+                fprintf(stderr, "%s:%d: expected 3 or 6 vertex values\n", path, line_number);
+                success = false;
+                break;
+            }
+
+            ++mesh->vertex_count;
+        }
+        else if (line[0] == 'f' && isspace((unsigned char)line[1]))
+        {
+            success = parse_face(mesh, path, line + 2, line_number);
+        }
+    }
+
+    fclose(file);
+
+    if (!success)
+    {
+        return false;
+    }
+
+    if (mesh->has_vertex_colors && has_colorless_vertex)
+    {
+        fprintf(stderr, "%s: either all vertices or none must have colors\n", path);
+        return false;
+    }
+
+    if (!mesh->has_vertex_colors)
+    {
+        fill_vertex_colors(mesh);
+    }
+
+    return true;
+}
+
+// Takes the position index of each "v", "v/vt", "v//vn" or "v/vt/vn" corner, resolving negative indices
+// relative to the vertices read so far
+static bool parse_face(Mesh* const mesh, const char* const path, const char* text, const int line_number)
+{
+    uint32_t corners[FACE_VERTEX_CAPACITY];
+    int corner_count = 0;
+
+    for (;;)
+    {
+        while (isspace((unsigned char)*text))
+        {
+            ++text;
+        }
+
+        if (*text == '\0')
+        {
+            break;
+        }
+
+        char* end;
+        const long index = strtol(text, &end, 10);
+        if (end == text || index == 0)
+        {
+            fprintf(stderr, "%s:%d: invalid face corner\n", path, line_number);
+            return false;
+        }
+
+        const long resolved = index > 0 ? index - 1 : (long)mesh->vertex_count + index;
+        if (resolved < 0 || resolved >= (long)mesh->vertex_count)
+        {
+            fprintf(stderr, "%s:%d: face references a missing vertex\n", path, line_number);
+            return false;
+        }
+
+        if (corner_count == FACE_VERTEX_CAPACITY)
+        {
+            fprintf(stderr, "%s:%d: face has more than %d vertices\n", path, line_number, FACE_VERTEX_CAPACITY);
+            return false;
+        }
+        corners[corner_count++] = (uint32_t)resolved;
+
+        text = end;
+        while (*text != '\0' && !isspace((unsigned char)*text))
+        {
+            ++text;
+        }
+    }
+
+    if (corner_count < 3)
+    {
+        fprintf(stderr, "%s:%d: face has fewer than 3 vertices\n", path, line_number);
+        return false;
+    }
+
+    const uint32_t triangle_count = (uint32_t)corner_count - 2;
+    uint32_t* const indices = grow_array(mesh->indices, &mesh->index_capacity,
+        mesh->index_count + triangle_count * 3, sizeof(uint32_t));
+    if (indices == NULL)
+    {
+        fputs("Failed to allocate memory for indices\n", stderr);
+        return false;
+    }
+    mesh->indices = indices;
+
+    for (uint32_t i = 0; i < triangle_count; ++i)
+    {
+        mesh->indices[mesh->index_count++] = corners[0];
+        mesh->indices[mesh->index_count++] = corners[i + 1];
+        mesh->indices[mesh->index_count++] = corners[i + 2];
+    }
+
+    return true;
+}
+
+// Colors each vertex by its position within the mesh's bounding box
+static void fill_vertex_colors(Mesh* const mesh)
+{
+    float min[3] = {0.0f, 0.0f, 0.0f};
+    float max[3] = {0.0f, 0.0f, 0.0f};
+
+    for (uint32_t i = 0; i < mesh->vertex_count; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const float value = mesh->vertices[i].position[j];
+            if (i == 0 || value < min[j])
+            {
+                min[j] = value;
+            }
+            if (i == 0 || value > max[j])
+            {
+                max[j] = value;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < mesh->vertex_count; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const float extent = max[j] - min[j];
+            mesh->vertices[i].color[j] = extent > 0.0f ? (mesh->vertices[i].position[j] - min[j]) / extent : 1.0f;
+        }
+    }
+}
+
+static bool write_mesh(const Mesh* const mesh, const char* const path)
+{
+    const uint64_t vertex_block_size = (uint64_t)mesh->vertex_count * sizeof(MeshFileVertex);
+    const uint64_t alignment_mask = MESH_FILE_BLOCK_ALIGNMENT - 1;
+
+    MeshFileHeader header = {
+        .magic = MESH_FILE_MAGIC,
+        .version = MESH_FILE_VERSION,
+        .vertex_count = mesh->vertex_count,
+        .index_count = mesh->index_count,
+        .vertex_offset = (sizeof(MeshFileHeader) + alignment_mask) & ~alignment_mask
+    };
+    header.index_offset = (header.vertex_offset + vertex_block_size + alignment_mask) & ~alignment_mask;
+
+    FILE* const file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s for writing\n", path);
+        return false;
+    }
+
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1
+        && write_padding(file, header.vertex_offset)
+        && fwrite(mesh->vertices, sizeof(MeshFileVertex), mesh->vertex_count, file) == mesh->vertex_count
+        && write_padding(file, header.index_offset)
+        && fwrite(mesh->indices, sizeof(uint32_t), mesh->index_count, file) == mesh->index_count;
+
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+
+    if (!success)
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+        remove(path);
+    }
+
+    return success;
+}
+
+static bool write_padding(FILE* const file, const uint64_t offset)
+{
+    const long position = ftell(file);
+    if (position < 0 || (uint64_t)position > offset)
+    {
+        return false;
+    }
+
+    for (uint64_t i = (uint64_t)position; i < offset; ++i)
+    {
+        if (fputc(0, file) == EOF)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void* grow_array(void* const data, uint32_t* const capacity, const uint32_t required_capacity,
+    const size_t element_size)
+{
+    if (required_capacity <= *capacity)
+    {
+        return data;
+    }
+
+    uint32_t new_capacity = *capacity > 0 ? *capacity : 16;
+    while (new_capacity < required_capacity)
+    {
+        new_capacity *= 2;
+    }
+
+    void* const new_data = realloc(data, new_capacity * element_size);
+    if (new_data != NULL)
+    {
+        *capacity = new_capacity;
+    }
+
+    return new_data;
+}
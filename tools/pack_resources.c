@@ -0,0 +1,235 @@
+#include "test_matrix/resource_pack.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct PackEntry
+{
+    const char* name;
+    const char* path;
+    unsigned char* data;
+    uint64_t size;
+} PackEntry;
+
+static bool read_file(PackEntry* const entry);
+
+static bool write_pack(const PackEntry* const entries, const uint32_t entry_count, const char* const path);
+
+static bool write_padding(FILE* const file, const uint64_t offset);
+
+static uint64_t align_up(const uint64_t value, const uint64_t alignment);
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc % 2 != 0)
+    {
+        fprintf(stderr, "Usage: %s OUTPUT.pack [NAME PATH]...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const uint32_t entry_count = (uint32_t)(argc - 2) / 2;
+
+    PackEntry* const entries = calloc(entry_count > 0 ? entry_count : 1, sizeof(PackEntry));
+    if (entries == NULL)
+    {
+        fputs("Failed to allocate memory for pack entries\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    bool success = true;
+    for (uint32_t i = 0; success && i < entry_count; ++i)
+    {
+        entries[i].name = argv[2 + 2 * i];
+        entries[i].path = argv[3 + 2 * i];
+
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            if (strcmp(entries[i].name, entries[j].name) == 0)
+            {
+                fprintf(stderr, "Resource %s is listed twice\n", entries[i].name);
+                success = false;
+            }
+        }
+
+        if (entries[i].name[0] == '\0')
+        {
+            fputs("Resource names can't be empty\n", stderr);
+            success = false;
+        }
+
+        success = success && read_file(&entries[i]);
+    }
+
+    success = success && write_pack(entries, entry_count, argv[1]);
+
+    for (uint32_t i = 0; i < entry_count; ++i)
+    {
+        free(entries[i].data);
+    }
+    free(entries);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static bool read_file(PackEntry* const entry)
+{
+    FILE* const file = fopen(entry->path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", entry->path);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    entry->data = malloc(size > 0 ? size : 1);
+    if (size < 0 || entry->data == NULL)
+    {
+        fprintf(stderr, "Failed to read %s\n", entry->path);
+        fclose(file);
+        return false;
+    }
+
+    entry->size = (uint64_t)size;
+
+    const bool is_read = size == 0 || fread(entry->data, size, 1, file) == 1;
+    fclose(file);
+
+    if (!is_read)
+    {
+        fprintf(stderr, "Failed to read %s\n", entry->path);
+    }
+
+    return is_read;
+}
+
+static bool write_pack(const PackEntry* const entries, const uint32_t entry_count, const char* const path)
+{
+    uint32_t slot_count = 1;
+    while (slot_count < 2 * entry_count + 1)
+    {
+        slot_count *= 2;
+    }
+
+    ResourcePackSlot* const slots = calloc(slot_count, sizeof(ResourcePackSlot));
+    if (slots == NULL)
+    {
+        fputs("Failed to allocate memory for pack slots\n", stderr);
+        return false;
+    }
+
+    ResourcePackHeader header = {
+        .magic = RESOURCE_PACK_MAGIC,
+        .version = RESOURCE_PACK_VERSION,
+        .slot_count = slot_count,
+        .entry_count = entry_count,
+        .slots_offset = align_up(sizeof(ResourcePackHeader), sizeof(uint64_t))
+    };
+    header.names_offset = header.slots_offset + (uint64_t)slot_count * sizeof(ResourcePackSlot);
+
+    uint64_t names_size = 0;
+    for (uint32_t i = 0; i < entry_count; ++i)
+    {
+        names_size += strlen(entries[i].name);
+    }
+
+    uint32_t name_offset = 0;
+    uint64_t data_offset = header.names_offset + names_size;
+    for (uint32_t i = 0; i < entry_count; ++i)
+    {
+        const size_t name_length = strlen(entries[i].name);
+        const uint64_t name_hash = resource_pack_hash_name(entries[i].name, name_length);
+
+        uint32_t slot = (uint32_t)name_hash & (slot_count - 1);
+        while (slots[slot].name_length != 0)
+        {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+
+        data_offset = align_up(data_offset, RESOURCE_PACK_DATA_ALIGNMENT);
+
+        slots[slot] = (ResourcePackSlot){
+            .name_hash = name_hash,
+            .data_offset = data_offset,
+            .data_size = entries[i].size,
+            .name_offset = name_offset,
+            .name_length = (uint32_t)name_length
+        };
+
+        name_offset += (uint32_t)name_length;
+        data_offset += entries[i].size + 1;
+    }
+
+    FILE* const file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Failed to open %s for writing\n", path);
+        free(slots);
+        return false;
+    }
+
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1
+        && write_padding(file, header.slots_offset)
+        && fwrite(slots, sizeof(ResourcePackSlot), slot_count, file) == slot_count;
+
+    for (uint32_t i = 0; success && i < entry_count; ++i)
+    {
+        success = fputs(entries[i].name, file) != EOF;
+    }
+
+    // Entries were laid out in argument order, so their data is written in the same order
+    uint64_t offset = header.names_offset + names_size;
+    for (uint32_t i = 0; success && i < entry_count; ++i)
+    {
+        offset = align_up(offset, RESOURCE_PACK_DATA_ALIGNMENT);
+        success = write_padding(file, offset)
+            && (entries[i].size == 0 || fwrite(entries[i].data, entries[i].size, 1, file) == 1)
+            && fputc('\0', file) != EOF;
+        offset += entries[i].size + 1;
+    }
+
+    if (fclose(file) != 0)
+    {
+        success = false;
+    }
+
+    if (!success)
+    {
+        fprintf(stderr, "Failed to write %s\n", path);
+        remove(path);
+    }
+
+    free(slots);
+
+    return success;
+}
+
+static bool write_padding(FILE* const file, const uint64_t offset)
+{
+    const long position = ftell(file);
+    if (position < 0 || (uint64_t)position > offset)
+    {
+        return false;
+    }
+
+    for (uint64_t i = (uint64_t)position; i < offset; ++i)
+    {
+        if (fputc(0, file) == EOF)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint64_t align_up(const uint64_t value, const uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}